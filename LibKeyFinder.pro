@@ -35,43 +35,96 @@ QMAKE_CXXFLAGS += -std=c++11
 DEFINES += LIBKEYFINDER_LIBRARY
 
 HEADERS += \
+    analysisdiagnostics.h \
+    arrowexport.h \
     audiodata.h \
+    batchjournal.h \
     binode.h \
+    chromafingerprint.h \
     chromagram.h \
     chromatransform.h \
     chromatransformfactory.h \
+    costestimator.h \
     constants.h \
     exception.h \
+    executiondomain.h \
     fftadapter.h \
+    hopcache.h \
+    hopfeatures.h \
     keyclassifier.h \
     keyfinder.h \
+    latencyhistogram.h \
     lowpassfilter.h \
     lowpassfilterfactory.h \
+    planregistry.h \
+    shadowevaluator.h \
     spectrumanalyser.h \
     temporalwindowfactory.h \
+    tonalitygate.h \
     toneprofiles.h \
     windowfunctions.h \
+    workloadrecorder.h \
     workspace.h
 
 SOURCES += \
+    analysisdiagnostics.cpp \
+    arrowexport.cpp \
     audiodata.cpp \
+    batchjournal.cpp \
+    chromafingerprint.cpp \
     chromagram.cpp \
     chromatransform.cpp \
     chromatransformfactory.cpp \
+    costestimator.cpp \
+    executiondomain.cpp \
     fftadapter.cpp \
+    hopcache.cpp \
+    hopfeatures.cpp \
     keyclassifier.cpp \
     keyfinder.cpp \
+    latencyhistogram.cpp \
     lowpassfilter.cpp \
     lowpassfilterfactory.cpp \
+    planregistry.cpp \
+    shadowevaluator.cpp \
     spectrumanalyser.cpp \
     temporalwindowfactory.cpp \
+    tonalitygate.cpp \
     toneprofiles.cpp \
     windowfunctions.cpp \
+    workloadrecorder.cpp \
     workspace.cpp \
     constants.cpp
 
 OTHER_FILES += README
 
+# Optional release profiles; see "Optimised builds" in the README.
+#   CONFIG+=lto           link-time optimisation
+#   CONFIG+=pgo-generate  instrumented build, for running benchmarks/training
+#   CONFIG+=pgo-use       build optimised with the profiles from that run
+lto{
+  CONFIG += ltcg
+}
+
+isEmpty(PGO_DIR): PGO_DIR = $$OUT_PWD/pgo
+
+pgo-generate{
+  QMAKE_CXXFLAGS += -fprofile-generate=$$PGO_DIR
+  QMAKE_LFLAGS += -fprofile-generate=$$PGO_DIR
+  *g++*: QMAKE_CXXFLAGS += -fprofile-update=atomic
+}
+
+pgo-use{
+  *clang*{
+    # clang needs the raw profiles merged first: llvm-profdata merge -o $$PGO_DIR/default.profdata $$PGO_DIR/*.profraw
+    QMAKE_CXXFLAGS += -fprofile-use=$$PGO_DIR/default.profdata -Wno-profile-instr-unprofiled
+    QMAKE_LFLAGS += -fprofile-use=$$PGO_DIR/default.profdata
+  } else {
+    QMAKE_CXXFLAGS += -fprofile-use=$$PGO_DIR -fprofile-correction -Wno-missing-profile
+    QMAKE_LFLAGS += -fprofile-use=$$PGO_DIR
+  }
+}
+
 macx{
   LIBS += -stdlib=libc++
   QMAKE_CXXFLAGS += -stdlib=libc++
@@ -95,6 +148,7 @@ unix{
   INCLUDEPATH += /usr/local/include
   LIBS += -L/usr/local/lib/
   LIBS += -lfftw3
+  LIBS += -lpthread
 
   INSTALLS += target headers
   headers.files = $$HEADERS
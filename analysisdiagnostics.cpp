@@ -0,0 +1,134 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#include "analysisdiagnostics.h"
+
+namespace KeyFinder {
+
+  static const char* STAGE_NAMES[] = { "mono", "lowpass", "downsample", "spectrum", "classify" };
+
+  AnalysisDiagnostics::AnalysisDiagnostics() :
+    frameRate(0), channels(0), frames(0), calls(0), downsampleFactor(0), filterTaps(0),
+    filterShortcut(false), fftEngine(), hops(0), cachedHops(0), maxRemainderSamples(0),
+    paddingSamples(0), peakBufferedSamples(0) {
+    for (unsigned int s = 0; s < STAGES; s++) {
+      stageSeconds[s] = 0.0;
+    }
+  }
+
+  const char* AnalysisDiagnostics::stageName(analysis_stage_t stage) {
+    if (stage >= STAGES) {
+      throw Exception("No such analysis stage");
+    }
+    return STAGE_NAMES[stage];
+  }
+
+  void AnalysisDiagnostics::lap(analysis_stage_t stage, std::chrono::steady_clock::time_point& since) {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    stageSeconds[stage] += std::chrono::duration<double>(now - since).count();
+    since = now;
+  }
+
+  double AnalysisDiagnostics::getTotalSeconds() const {
+    double total = 0.0;
+    for (unsigned int s = 0; s < STAGES; s++) {
+      total += stageSeconds[s];
+    }
+    return total;
+  }
+
+  // The dominant stage, then whichever of the known causes of slow analyses
+  // apply; the thresholds are rough, and only meant to point the way.
+  std::string AnalysisDiagnostics::costDrivers() const {
+    std::ostringstream drivers;
+    double total = getTotalSeconds();
+    if (total > 0.0) {
+      unsigned int top = 0;
+      for (unsigned int s = 1; s < STAGES; s++) {
+        if (stageSeconds[s] > stageSeconds[top]) {
+          top = s;
+        }
+      }
+      drivers << STAGE_NAMES[top] << " took " << (int)(100.0 * stageSeconds[top] / total + 0.5) << "% of " << total << "s";
+    }
+    std::vector<std::string> causes;
+    std::ostringstream cause;
+    if (frameRate > 96000) {
+      cause << "high input rate (" << frameRate << "Hz through a " << filterTaps << "-tap filter)";
+      causes.push_back(cause.str());
+      cause.str("");
+    }
+    if (frameRate > 0 && downsampleFactor <= 1) {
+      cause << "no downsampling at " << frameRate << "Hz";
+      causes.push_back(cause.str());
+      cause.str("");
+    }
+    if (channels > 2) {
+      cause << channels << " channels mixed to mono";
+      causes.push_back(cause.str());
+      cause.str("");
+    }
+    if (calls > 1 && frames / calls < 1024) {
+      cause << "small packets (" << calls << " calls of " << frames / calls << " frames)";
+      causes.push_back(cause.str());
+      cause.str("");
+    }
+    if (hops > 7200) {
+      cause << "long input (" << hops << " hops)";
+      causes.push_back(cause.str());
+      cause.str("");
+    }
+    if (hops > 0 && paddingSamples > hops * HOPSIZE / 2) {
+      cause << "short input (" << paddingSamples << " samples of padding)";
+      causes.push_back(cause.str());
+      cause.str("");
+    }
+    for (unsigned int i = 0; i < causes.size(); i++) {
+      if (i > 0 || total > 0.0) {
+        drivers << "; ";
+      }
+      drivers << causes[i];
+    }
+    return drivers.str();
+  }
+
+  // one "name: value" line per field, for attaching to logs
+  void AnalysisDiagnostics::write(std::ostream& report) const {
+    report << "frameRate: " << frameRate << "\n";
+    report << "channels: " << channels << "\n";
+    report << "frames: " << frames << "\n";
+    report << "calls: " << calls << "\n";
+    report << "downsampleFactor: " << downsampleFactor << "\n";
+    report << "filterTaps: " << filterTaps << "\n";
+    report << "filterShortcut: " << (filterShortcut ? "yes" : "no") << "\n";
+    report << "fftEngine: " << fftEngine << "\n";
+    report << "hops: " << hops << "\n";
+    report << "cachedHops: " << cachedHops << "\n";
+    report << "maxRemainderSamples: " << maxRemainderSamples << "\n";
+    report << "paddingSamples: " << paddingSamples << "\n";
+    report << "peakBufferedSamples: " << peakBufferedSamples << "\n";
+    for (unsigned int s = 0; s < STAGES; s++) {
+      report << "seconds." << STAGE_NAMES[s] << ": " << stageSeconds[s] << "\n";
+    }
+    report << "costDrivers: " << costDrivers() << "\n";
+  }
+
+}
@@ -0,0 +1,70 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#ifndef ANALYSISDIAGNOSTICS_H
+#define ANALYSISDIAGNOSTICS_H
+
+#include "constants.h"
+#include <chrono>
+#include <ostream>
+#include <string>
+
+namespace KeyFinder {
+
+  enum analysis_stage_t {
+    STAGE_MONO,
+    STAGE_LOWPASS,
+    STAGE_DOWNSAMPLE,
+    STAGE_SPECTRUM,
+    STAGE_CLASSIFY,
+    STAGES
+  };
+
+  // What one analysis did and where its time went, for attaching to reports
+  // of unusually slow jobs. Filled in by KeyFinder when a workspace points
+  // at one, or when passed to keyOfAudio.
+  class AnalysisDiagnostics {
+  public:
+    AnalysisDiagnostics();
+    unsigned int frameRate;
+    unsigned int channels;
+    unsigned long long frames;         // input, over all calls
+    unsigned long long calls;          // progressiveChromagram calls, or 1
+    unsigned int downsampleFactor;
+    unsigned int filterTaps;
+    bool filterShortcut;               // only computing the outputs kept by downsampling
+    std::string fftEngine;
+    unsigned long long hops;
+    unsigned long long cachedHops;     // taken from a HopCache
+    size_t maxRemainderSamples;        // carried between calls for downsampling
+    unsigned long long paddingSamples; // zeros added to complete the last frame
+    size_t peakBufferedSamples;        // preprocessed audio awaiting a whole frame
+    double stageSeconds[STAGES];
+    void lap(analysis_stage_t stage, std::chrono::steady_clock::time_point& since);
+    double getTotalSeconds() const;
+    std::string costDrivers() const;
+    void write(std::ostream& report) const;
+    static const char* stageName(analysis_stage_t stage);
+  };
+
+}
+
+#endif
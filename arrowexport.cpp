@@ -0,0 +1,231 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#include "arrowexport.h"
+
+namespace KeyFinder {
+
+  // Everything an exported array points at lives here, freed on release.
+  class ExportedArray {
+  public:
+    std::vector<const void*> buffers;
+    std::vector<ArrowArray*> children;
+    std::vector<double> values;
+    std::vector<int32_t> integers;
+    std::vector<int32_t> offsets;
+    std::string characters;
+    std::vector<uint8_t> validity;
+  };
+
+  class ExportedSchema {
+  public:
+    std::string format;
+    std::string name;
+    std::vector<ArrowSchema*> children;
+  };
+
+  // consumers may expect a real address even for an empty buffer
+  template <typename T>
+  static const void* bufferOf(std::vector<T>& data) {
+    if (data.empty()) {
+      data.reserve(1);
+    }
+    return data.data();
+  }
+
+  static void releaseArray(ArrowArray* array) {
+    ExportedArray* exported = (ExportedArray*)array->private_data;
+    for (unsigned int i = 0; i < exported->children.size(); i++) {
+      ArrowArray* child = exported->children[i];
+      if (child->release != NULL) {
+        child->release(child);
+      }
+      delete child;
+    }
+    delete exported;
+    array->release = NULL;
+  }
+
+  static void releaseSchema(ArrowSchema* schema) {
+    ExportedSchema* exported = (ExportedSchema*)schema->private_data;
+    for (unsigned int i = 0; i < exported->children.size(); i++) {
+      ArrowSchema* child = exported->children[i];
+      if (child->release != NULL) {
+        child->release(child);
+      }
+      delete child;
+    }
+    delete exported;
+    schema->release = NULL;
+  }
+
+  static void fillArray(ArrowArray* array, ExportedArray* exported, int64_t length, int64_t nullCount) {
+    array->length = length;
+    array->null_count = nullCount;
+    array->offset = 0;
+    array->n_buffers = exported->buffers.size();
+    array->n_children = exported->children.size();
+    array->buffers = exported->buffers.empty() ? NULL : &exported->buffers[0];
+    array->children = exported->children.empty() ? NULL : &exported->children[0];
+    array->dictionary = NULL;
+    array->release = releaseArray;
+    array->private_data = exported;
+  }
+
+  static void fillSchema(ArrowSchema* schema, ExportedSchema* exported, int64_t flags) {
+    schema->format = exported->format.c_str();
+    schema->name = exported->name.c_str();
+    schema->metadata = NULL;
+    schema->flags = flags;
+    schema->n_children = exported->children.size();
+    schema->children = exported->children.empty() ? NULL : &exported->children[0];
+    schema->dictionary = NULL;
+    schema->release = releaseSchema;
+    schema->private_data = exported;
+  }
+
+  static ExportedSchema* newSchema(const std::string& format, const std::string& name) {
+    ExportedSchema* exported = new ExportedSchema();
+    exported->format = format;
+    exported->name = name;
+    return exported;
+  }
+
+  // a fixed-size list of doubles over values, which the array takes over
+  static void exportRowsOfDoubles(std::vector<double>& values, unsigned int width, const std::string& name, ArrowArray* array, ArrowSchema* schema, const std::vector<uint8_t>* validity = NULL, int64_t nullCount = 0) {
+    std::ostringstream format;
+    format << "+w:" << width;
+
+    ExportedArray* items = new ExportedArray();
+    items->values.swap(values);
+    items->buffers.push_back(NULL);
+    items->buffers.push_back(bufferOf(items->values));
+    ArrowArray* itemArray = new ArrowArray();
+    fillArray(itemArray, items, items->values.size(), 0);
+
+    ExportedArray* rows = new ExportedArray();
+    if (validity != NULL) {
+      rows->validity = *validity;
+    }
+    rows->buffers.push_back(rows->validity.empty() ? NULL : bufferOf(rows->validity));
+    rows->children.push_back(itemArray);
+    fillArray(array, rows, itemArray->length / width, nullCount);
+
+    ExportedSchema* itemSchema = newSchema("g", "item");
+    ArrowSchema* itemSchemaStruct = new ArrowSchema();
+    fillSchema(itemSchemaStruct, itemSchema, 0);
+    ExportedSchema* rowSchema = newSchema(format.str(), name);
+    rowSchema->children.push_back(itemSchemaStruct);
+    fillSchema(schema, rowSchema, validity != NULL ? ARROW_FLAG_NULLABLE : 0);
+  }
+
+  void exportChromagram(Chromagram& chromagram, ArrowArray* array, ArrowSchema* schema) {
+    std::vector<double> values;
+    chromagram.swapData(values);
+    exportRowsOfDoubles(values, BANDS, "chromagram", array, schema);
+  }
+
+  void exportHopScores(const Chromagram& chromagram, const KeyClassifier& classifier, ArrowArray* array, ArrowSchema* schema) {
+    const unsigned int width = KEYS + 1;
+    std::vector<double> values(chromagram.getHops() * width);
+    std::vector<double> hop(BANDS);
+    for (size_t h = 0; h < chromagram.getHops(); h++) {
+      for (unsigned int b = 0; b < BANDS; b++) {
+        hop[b] = chromagram.getMagnitude(h, b);
+      }
+      std::vector<double> scores = classifier.scores(hop);
+      std::copy(scores.begin(), scores.end(), values.begin() + h * width);
+    }
+    exportRowsOfDoubles(values, width, "scores", array, schema);
+  }
+
+  void exportBatchResults(const std::vector<BatchResult>& results, ArrowArray* array, ArrowSchema* schema) {
+
+    size_t characters = 0;
+    for (unsigned int i = 0; i < results.size(); i++) {
+      characters += results[i].path.size();
+      if (!results[i].chromaVector.empty() && results[i].chromaVector.size() != BANDS) {
+        std::ostringstream ss;
+        ss << "Cannot export a chroma vector of " << results[i].chromaVector.size() << " bands";
+        throw Exception(ss.str().c_str());
+      }
+    }
+    if (characters > INT32_MAX) {
+      throw Exception("Cannot export more than 2GB of paths");
+    }
+
+    ExportedArray* paths = new ExportedArray();
+    paths->offsets.push_back(0);
+    paths->characters.reserve(characters);
+    for (unsigned int i = 0; i < results.size(); i++) {
+      paths->characters += results[i].path;
+      paths->offsets.push_back(paths->characters.size());
+    }
+    paths->buffers.push_back(NULL);
+    paths->buffers.push_back(bufferOf(paths->offsets));
+    paths->buffers.push_back(paths->characters.data());
+    ArrowArray* pathArray = new ArrowArray();
+    fillArray(pathArray, paths, results.size(), 0);
+
+    ExportedArray* keys = new ExportedArray();
+    for (unsigned int i = 0; i < results.size(); i++) {
+      keys->integers.push_back(results[i].key);
+    }
+    keys->buffers.push_back(NULL);
+    keys->buffers.push_back(bufferOf(keys->integers));
+    ArrowArray* keyArray = new ArrowArray();
+    fillArray(keyArray, keys, results.size(), 0);
+
+    // null rows still take up their BANDS slots in the values
+    std::vector<double> values(results.size() * BANDS, 0.0);
+    std::vector<uint8_t> validity((results.size() + 7) / 8, 0);
+    int64_t nulls = 0;
+    for (unsigned int i = 0; i < results.size(); i++) {
+      if (results[i].chromaVector.empty()) {
+        nulls++;
+        continue;
+      }
+      validity[i / 8] |= (uint8_t)(1 << (i % 8));
+      std::copy(results[i].chromaVector.begin(), results[i].chromaVector.end(), values.begin() + (size_t)i * BANDS);
+    }
+    ArrowArray* chromaArray = new ArrowArray();
+    ArrowSchema* chromaSchema = new ArrowSchema();
+    exportRowsOfDoubles(values, BANDS, "chroma", chromaArray, chromaSchema, &validity, nulls);
+
+    ExportedArray* table = new ExportedArray();
+    table->buffers.push_back(NULL);
+    table->children.push_back(pathArray);
+    table->children.push_back(keyArray);
+    table->children.push_back(chromaArray);
+    fillArray(array, table, results.size(), 0);
+
+    ArrowSchema* pathSchema = new ArrowSchema();
+    fillSchema(pathSchema, newSchema("u", "path"), 0);
+    ArrowSchema* keySchema = new ArrowSchema();
+    fillSchema(keySchema, newSchema("i", "key"), 0);
+    ExportedSchema* tableSchema = newSchema("+s", "");
+    tableSchema->children.push_back(pathSchema);
+    tableSchema->children.push_back(keySchema);
+    tableSchema->children.push_back(chromaSchema);
+    fillSchema(schema, tableSchema, 0);
+  }
+
+}
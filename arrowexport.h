@@ -0,0 +1,96 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#ifndef ARROWEXPORT_H
+#define ARROWEXPORT_H
+
+#include "constants.h"
+#include "chromagram.h"
+#include "keyclassifier.h"
+#include "batchjournal.h"
+#include <stdint.h>
+
+// The Arrow C data interface, as published in the Arrow specification. Any
+// consumer that defines the same structs can take these arrays; there is no
+// dependency on an Arrow library.
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+  // Array type description
+  const char* format;
+  const char* name;
+  const char* metadata;
+  int64_t flags;
+  int64_t n_children;
+  struct ArrowSchema** children;
+  struct ArrowSchema* dictionary;
+
+  // Release callback
+  void (*release)(struct ArrowSchema*);
+  // Opaque producer-specific data
+  void* private_data;
+};
+
+struct ArrowArray {
+  // Array data description
+  int64_t length;
+  int64_t null_count;
+  int64_t offset;
+  int64_t n_buffers;
+  int64_t n_children;
+  const void** buffers;
+  struct ArrowArray** children;
+  struct ArrowArray* dictionary;
+
+  // Release callback
+  void (*release)(struct ArrowArray*);
+  // Opaque producer-specific data
+  void* private_data;
+};
+
+#endif // ARROW_C_DATA_INTERFACE
+
+namespace KeyFinder {
+
+  // Each export fills in a caller-allocated array and schema, whose buffers
+  // belong to the library until the consumer calls their release callbacks.
+
+  // fixed_size_list<double>[BANDS], one row per hop. The chromagram's own
+  // buffer is handed over without a copy, leaving the chromagram empty.
+  void exportChromagram(Chromagram& chromagram, ArrowArray* array, ArrowSchema* schema);
+
+  // fixed_size_list<double>[KEYS + 1], the classifier's scores for each hop,
+  // indexed by key_t, written straight into the exported buffer
+  void exportHopScores(const Chromagram& chromagram, const KeyClassifier& classifier, ArrowArray* array, ArrowSchema* schema);
+
+  // struct<path: utf8, key: int32, chroma: fixed_size_list<double>[BANDS]>,
+  // with key holding key_t values and chroma null for results without one;
+  // importable as a record batch
+  void exportBatchResults(const std::vector<BatchResult>& results, ArrowArray* array, ArrowSchema* schema);
+
+}
+
+#endif
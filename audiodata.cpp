@@ -76,7 +76,7 @@ namespace KeyFinder {
   }
 
   // get sample by absolute index
-  double AudioData::getSample(unsigned int index) const {
+  double AudioData::getSample(size_t index) const {
     if (index >= getSampleCount()) {
       std::ostringstream ss;
       ss << "Cannot get out-of-bounds sample (" << index << "/" << getSampleCount() << ")";
@@ -86,7 +86,7 @@ namespace KeyFinder {
   }
 
   // get sample by frame and channel
-  double AudioData::getSampleByFrame(unsigned int frame, unsigned int channel) const {
+  double AudioData::getSampleByFrame(size_t frame, unsigned int channel) const {
     if (frame >= getFrameCount()) {
       std::ostringstream ss;
       ss << "Cannot get out-of-bounds frame (" << frame << "/" << getFrameCount() << ")";
@@ -101,7 +101,7 @@ namespace KeyFinder {
   }
 
   // set sample by absolute index
-  void AudioData::setSample(unsigned int index, double value) {
+  void AudioData::setSample(size_t index, double value) {
     if (index >= getSampleCount()) {
       std::ostringstream ss;
       ss << "Cannot set out-of-bounds sample (" << index << "/" << getSampleCount() << ")";
@@ -114,7 +114,7 @@ namespace KeyFinder {
   }
 
   // set sample by frame and channel
-  void AudioData::setSampleByFrame(unsigned int frame, unsigned int channel, double value) {
+  void AudioData::setSampleByFrame(size_t frame, unsigned int channel, double value) {
     if (frame >= getFrameCount()) {
       std::ostringstream ss;
       ss << "Cannot set out-of-bounds frame (" << frame << "/" << getFrameCount() << ")";
@@ -128,22 +128,22 @@ namespace KeyFinder {
     setSample(frame * channels + channel, value);
   }
 
-  void AudioData::addToSampleCount(unsigned int inSamples) {
+  void AudioData::addToSampleCount(size_t inSamples) {
     samples.resize(getSampleCount() + inSamples, 0.0);
   }
 
-  void AudioData::addToFrameCount(unsigned int inFrames) {
+  void AudioData::addToFrameCount(size_t inFrames) {
     if (channels < 1) {
       throw Exception("Channels must be > 0");
     }
     addToSampleCount(inFrames * channels);
   }
 
-  unsigned int AudioData::getSampleCount() const {
+  size_t AudioData::getSampleCount() const {
     return samples.size();
   }
 
-  unsigned int AudioData::getFrameCount() const {
+  size_t AudioData::getFrameCount() const {
     if (channels < 1) {
       throw Exception("Channels must be > 0");
     }
@@ -206,23 +206,23 @@ namespace KeyFinder {
       *writeAt = mean;
       std::advance(writeAt, 1);
     }
-    samples.resize(ceil((double)getSampleCount() / (double)factor));
+    samples.resize((getSampleCount() + factor - 1) / factor);
     setFrameRate(getFrameRate() / factor);
   }
 
-  void AudioData::discardFramesFromFront(unsigned int discardFrameCount) {
+  void AudioData::discardFramesFromFront(size_t discardFrameCount) {
     if (discardFrameCount > getFrameCount()) {
       std::ostringstream ss;
       ss << "Cannot discard " << discardFrameCount << " frames of " << getFrameCount();
       throw Exception(ss.str().c_str());
     }
-    unsigned int discardSampleCount = discardFrameCount * channels;
+    size_t discardSampleCount = discardFrameCount * channels;
     std::deque<double>::iterator discardToHere = samples.begin();
     std::advance(discardToHere, discardSampleCount);
     samples.erase(samples.begin(), discardToHere);
   }
 
-  AudioData* AudioData::sliceSamplesFromBack(unsigned int sliceSampleCount) {
+  AudioData* AudioData::sliceSamplesFromBack(size_t sliceSampleCount) {
 
     if (sliceSampleCount > getSampleCount()) {
       std::ostringstream ss;
@@ -230,7 +230,7 @@ namespace KeyFinder {
       throw Exception(ss.str().c_str());
     }
 
-    unsigned int samplesToLeaveIntact = getSampleCount() - sliceSampleCount;
+    size_t samplesToLeaveIntact = getSampleCount() - sliceSampleCount;
 
     AudioData* that = new AudioData();
     that->channels = channels;
@@ -251,6 +251,55 @@ namespace KeyFinder {
     return that;
   }
 
+  AudioData* AudioData::copyFrames(size_t firstFrame, size_t copyFrameCount) const {
+
+    if (firstFrame > getFrameCount() || copyFrameCount > getFrameCount() - firstFrame) {
+      std::ostringstream ss;
+      ss << "Cannot copy frames " << firstFrame << "-" << firstFrame + copyFrameCount << " of " << getFrameCount();
+      throw Exception(ss.str().c_str());
+    }
+
+    AudioData* that = new AudioData();
+    that->channels = channels;
+    that->setFrameRate(getFrameRate());
+
+    std::deque<double>::const_iterator copyFromHere = samples.begin();
+    std::advance(copyFromHere, firstFrame * channels);
+    std::deque<double>::const_iterator copyToHere = copyFromHere;
+    std::advance(copyToHere, copyFrameCount * channels);
+    that->samples.assign(copyFromHere, copyToHere);
+
+    return that;
+  }
+
+  AudioData* AudioData::mixToMono(const std::vector<double>& channelWeights) const {
+
+    if (channelWeights.size() != channels) {
+      std::ostringstream ss;
+      ss << "Cannot mix " << channels << " channels with " << channelWeights.size() << " weights";
+      throw Exception(ss.str().c_str());
+    }
+
+    AudioData* that = new AudioData();
+    that->channels = 1;
+    that->setFrameRate(getFrameRate());
+    that->addToSampleCount(getFrameCount());
+
+    std::deque<double>::const_iterator readAt = samples.begin();
+    std::deque<double>::iterator writeAt = that->samples.begin();
+    while (writeAt < that->samples.end()) {
+      double sum = 0.0;
+      for (unsigned int c = 0; c < channels; c++) {
+        sum += *readAt * channelWeights[c];
+        std::advance(readAt, 1);
+      }
+      *writeAt = sum;
+      std::advance(writeAt, 1);
+    }
+
+    return that;
+  }
+
   void AudioData::resetIterators() {
     readIterator = samples.begin();
     writeIterator = samples.begin();
@@ -264,11 +313,11 @@ namespace KeyFinder {
     return (writeIterator < samples.end());
   }
 
-  void AudioData::advanceReadIterator(unsigned int by) {
+  void AudioData::advanceReadIterator(size_t by) {
     std::advance(readIterator, by);
   }
 
-  void AudioData::advanceWriteIterator(unsigned int by) {
+  void AudioData::advanceWriteIterator(size_t by) {
     std::advance(writeIterator, by);
   }
 
@@ -32,32 +32,34 @@ namespace KeyFinder {
 
     unsigned int getChannels() const;
     unsigned int getFrameRate() const;
-    double getSample(unsigned int index) const;
-    double getSampleByFrame(unsigned int frame, unsigned int channel) const;
+    double getSample(size_t index) const;
+    double getSampleByFrame(size_t frame, unsigned int channel) const;
     double getSampleAtReadIterator() const;
-    unsigned int getSampleCount() const;
-    unsigned int getFrameCount() const;
+    size_t getSampleCount() const;
+    size_t getFrameCount() const;
 
     void setChannels(unsigned int newChannels);
     void setFrameRate(unsigned int newFrameRate);
-    void setSample(unsigned int index, double value);
-    void setSampleByFrame(unsigned int frame, unsigned int channels, double value);
+    void setSample(size_t index, double value);
+    void setSampleByFrame(size_t frame, unsigned int channels, double value);
     void setSampleAtWriteIterator(double value);
-    void addToSampleCount(unsigned int newSamples);
-    void addToFrameCount(unsigned int newFrames);
+    void addToSampleCount(size_t newSamples);
+    void addToFrameCount(size_t newFrames);
 
-    void advanceReadIterator(unsigned int by = 1);
-    void advanceWriteIterator(unsigned int by = 1);
+    void advanceReadIterator(size_t by = 1);
+    void advanceWriteIterator(size_t by = 1);
     bool readIteratorWithinUpperBound() const;
     bool writeIteratorWithinUpperBound() const;
     void resetIterators();
 
     void append(const AudioData& that);
     void prepend(const AudioData& that);
-    void discardFramesFromFront(unsigned int discardFrameCount);
+    void discardFramesFromFront(size_t discardFrameCount);
     void reduceToMono();
     void downsample(unsigned int factor, bool shortcut = true);
-    AudioData* sliceSamplesFromBack(unsigned int sliceSampleCount);
+    AudioData* sliceSamplesFromBack(size_t sliceSampleCount);
+    AudioData* copyFrames(size_t firstFrame, size_t copyFrameCount) const;
+    AudioData* mixToMono(const std::vector<double>& channelWeights) const;
 
   private:
     std::deque<double> samples;
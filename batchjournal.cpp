@@ -0,0 +1,267 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#include "batchjournal.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace KeyFinder {
+
+  ShardSpec::ShardSpec(unsigned int inIndex, unsigned int inCount) : index(inIndex), count(inCount) {
+    if (count < 1 || index >= count) {
+      throw Exception("Shard index must be less than shard count");
+    }
+  }
+
+  ShardSpec::ShardSpec(const std::string& spec) {
+    std::istringstream ss(spec);
+    char separator = 0;
+    long long inIndex = -1;
+    long long inCount = 0;
+    ss >> inIndex >> separator >> inCount;
+    if (ss.fail() || !ss.eof() || separator != '/' || inIndex < 0 || inCount < 1 || inIndex >= inCount) {
+      std::ostringstream error;
+      error << "Invalid shard specification (" << spec << "), expected i/n";
+      throw Exception(error.str().c_str());
+    }
+    index = inIndex;
+    count = inCount;
+  }
+
+  unsigned int ShardSpec::getIndex() const {
+    return index;
+  }
+
+  unsigned int ShardSpec::getCount() const {
+    return count;
+  }
+
+  bool ShardSpec::includes(const std::string& path) const {
+    return pathHash(path) % count == index;
+  }
+
+  // 64-bit FNV-1a; must never change, or shards from different builds disagree
+  unsigned long long ShardSpec::pathHash(const std::string& path) {
+    unsigned long long hash = 14695981039346656037ULL;
+    for (unsigned int i = 0; i < path.size(); i++) {
+      hash ^= (unsigned char)path[i];
+      hash *= 1099511628211ULL;
+    }
+    return hash;
+  }
+
+  // Record: key, chroma count, chroma values, escaped path, checksum; tab separated.
+
+  static std::string escapePath(const std::string& path) {
+    std::string escaped;
+    for (unsigned int i = 0; i < path.size(); i++) {
+      switch (path[i]) {
+        case '\\': escaped += "\\\\"; break;
+        case '\t': escaped += "\\t"; break;
+        case '\n': escaped += "\\n"; break;
+        case '\r': escaped += "\\r"; break;
+        default: escaped += path[i];
+      }
+    }
+    return escaped;
+  }
+
+  static bool unescapePath(const std::string& escaped, std::string& path) {
+    path.clear();
+    for (unsigned int i = 0; i < escaped.size(); i++) {
+      if (escaped[i] != '\\') {
+        path += escaped[i];
+        continue;
+      }
+      if (++i >= escaped.size()) {
+        return false;
+      }
+      switch (escaped[i]) {
+        case '\\': path += '\\'; break;
+        case 't': path += '\t'; break;
+        case 'n': path += '\n'; break;
+        case 'r': path += '\r'; break;
+        default: return false;
+      }
+    }
+    return true;
+  }
+
+  static std::string formatRecord(const BatchResult& result) {
+    std::ostringstream body;
+    body.precision(17);
+    body << (int)result.key << "\t" << result.chromaVector.size() << "\t";
+    for (unsigned int i = 0; i < result.chromaVector.size(); i++) {
+      body << (i > 0 ? "," : "") << result.chromaVector[i];
+    }
+    body << "\t" << escapePath(result.path);
+    std::ostringstream record;
+    record << body.str() << "\t" << std::hex << ShardSpec::pathHash(body.str()) << "\n";
+    return record.str();
+  }
+
+  static bool parseRecord(const std::string& line, BatchResult& result) {
+    size_t checksumAt = line.rfind('\t');
+    if (checksumAt == std::string::npos) {
+      return false;
+    }
+    std::string body = line.substr(0, checksumAt);
+    std::ostringstream checksum;
+    checksum << std::hex << ShardSpec::pathHash(body);
+    if (line.substr(checksumAt + 1) != checksum.str()) {
+      return false;
+    }
+    std::istringstream fields(body);
+    std::string field;
+    int key;
+    unsigned int chromaCount;
+    if (!std::getline(fields, field, '\t') || !(std::istringstream(field) >> key) || key < 0 || key > SILENCE) {
+      return false;
+    }
+    if (!std::getline(fields, field, '\t') || !(std::istringstream(field) >> chromaCount)) {
+      return false;
+    }
+    if (!std::getline(fields, field, '\t')) {
+      return false;
+    }
+    result.key = (key_t)key;
+    result.chromaVector.clear();
+    std::istringstream values(field);
+    std::string value;
+    while (std::getline(values, value, ',')) {
+      result.chromaVector.push_back(atof(value.c_str()));
+    }
+    if (result.chromaVector.size() != chromaCount) {
+      return false;
+    }
+    std::getline(fields, field);
+    return unescapePath(field, result.path);
+  }
+
+  BatchJournal::BatchJournal(const std::string& filename) : file(NULL), needsNewline(false) {
+    std::ifstream existing(filename.c_str(), std::ios::binary);
+    if (existing) {
+      std::string contents((std::istreambuf_iterator<char>(existing)), std::istreambuf_iterator<char>());
+      needsNewline = !contents.empty() && contents[contents.size() - 1] != '\n';
+      results = read(filename);
+      for (unsigned int i = 0; i < results.size(); i++) {
+        paths.insert(results[i].path);
+      }
+    }
+    file = std::fopen(filename.c_str(), "ab");
+    if (file == NULL) {
+      std::ostringstream ss;
+      ss << "Cannot open journal " << filename;
+      throw Exception(ss.str().c_str());
+    }
+  }
+
+  BatchJournal::~BatchJournal() {
+    std::fclose(file);
+  }
+
+  bool BatchJournal::contains(const std::string& path) const {
+    return paths.count(path) > 0;
+  }
+
+  void BatchJournal::append(const BatchResult& result) {
+    std::string record = formatRecord(result);
+    if (needsNewline) {
+      // terminate a record torn by a crash, so it is skipped on reading
+      record = "\n" + record;
+      needsNewline = false;
+    }
+    if (std::fwrite(record.data(), 1, record.size(), file) != record.size() || std::fflush(file) != 0) {
+      throw Exception("Cannot write to journal");
+    }
+#ifndef _WIN32
+    if (fsync(fileno(file)) != 0) {
+      throw Exception("Cannot sync journal to disk");
+    }
+#endif
+    results.push_back(result);
+    paths.insert(result.path);
+  }
+
+  std::vector<BatchResult> BatchJournal::getResults() const {
+    return results;
+  }
+
+  std::vector<BatchResult> BatchJournal::read(const std::string& filename) {
+    std::vector<BatchResult> readResults;
+    std::ifstream journal(filename.c_str(), std::ios::binary);
+    if (!journal) {
+      std::ostringstream ss;
+      ss << "Cannot open journal " << filename;
+      throw Exception(ss.str().c_str());
+    }
+    std::string line;
+    while (std::getline(journal, line)) {
+      if (journal.eof()) {
+        break; // unterminated, so possibly incomplete
+      }
+      BatchResult result;
+      if (parseRecord(line, result)) {
+        readResults.push_back(result);
+      }
+    }
+    return readResults;
+  }
+
+  // Combines shard journals into one result set ordered by path; if a path
+  // appears more than once, the last record read wins. A journal that can't
+  // be opened would leave its shard's results out, so that throws, naming
+  // every such journal.
+  std::vector<BatchResult> BatchJournal::merge(const std::vector<std::string>& filenames) {
+    std::map<std::string, BatchResult> merged;
+    std::vector<std::string> unopened;
+    for (unsigned int f = 0; f < filenames.size(); f++) {
+      std::ifstream journal(filenames[f].c_str(), std::ios::binary);
+      if (!journal) {
+        unopened.push_back(filenames[f]);
+        continue;
+      }
+      std::vector<BatchResult> shard = read(filenames[f]);
+      for (unsigned int i = 0; i < shard.size(); i++) {
+        merged[shard[i].path] = shard[i];
+      }
+    }
+    if (!unopened.empty()) {
+      std::ostringstream ss;
+      ss << "Cannot open journal" << (unopened.size() > 1 ? "s " : " ") << unopened[0];
+      for (unsigned int f = 1; f < unopened.size(); f++) {
+        ss << ", " << unopened[f];
+      }
+      throw Exception(ss.str().c_str());
+    }
+    std::vector<BatchResult> mergedResults;
+    for (std::map<std::string, BatchResult>::const_iterator it = merged.begin(); it != merged.end(); ++it) {
+      mergedResults.push_back(it->second);
+    }
+    return mergedResults;
+  }
+
+}
@@ -0,0 +1,77 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#ifndef BATCHJOURNAL_H
+#define BATCHJOURNAL_H
+
+#include "constants.h"
+#include <cstdio>
+#include <set>
+#include <string>
+
+namespace KeyFinder {
+
+  // Selects shard i of n from a corpus by a stable hash of each path, so that
+  // independent processes agree on the split without coordinating.
+  class ShardSpec {
+  public:
+    ShardSpec(unsigned int index = 0, unsigned int count = 1);
+    ShardSpec(const std::string& spec); // "i/n", zero-based
+    unsigned int getIndex() const;
+    unsigned int getCount() const;
+    bool includes(const std::string& path) const;
+    static unsigned long long pathHash(const std::string& path);
+  private:
+    unsigned int index;
+    unsigned int count;
+  };
+
+  class BatchResult {
+  public:
+    std::string path;
+    key_t key;
+    std::vector<double> chromaVector; // optional
+  };
+
+  // Append-only record of batch results. Each record is written and flushed
+  // as a single checksummed line, so a journal cut short by a crash loses at
+  // most the record in flight, and reopening it resumes where it left off.
+  class BatchJournal {
+  public:
+    BatchJournal(const std::string& filename);
+    ~BatchJournal();
+    bool contains(const std::string& path) const;
+    void append(const BatchResult& result);
+    std::vector<BatchResult> getResults() const;
+    static std::vector<BatchResult> read(const std::string& filename);
+    static std::vector<BatchResult> merge(const std::vector<std::string>& filenames);
+  private:
+    BatchJournal(const BatchJournal&);
+    BatchJournal& operator=(const BatchJournal&);
+    std::vector<BatchResult> results;
+    std::set<std::string> paths;
+    std::FILE* file;
+    bool needsNewline;
+  };
+
+}
+
+#endif
@@ -0,0 +1,74 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#include "_benchhelpers.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+KeyFinder::AudioData synthetic_audio (
+  unsigned int frames,
+  unsigned int channels,
+  unsigned int frameRate,
+  unsigned int firstFrame
+) {
+  KeyFinder::AudioData a;
+  a.setChannels(channels);
+  a.setFrameRate(frameRate);
+  a.addToFrameCount(frames);
+  for (unsigned int f = 0; f < frames; f++) {
+    double t = (firstFrame + f) / (double)frameRate;
+    double sample = 0.0;
+    sample += sin(t * 440.0000 * 2.0 * PI);
+    sample += sin(t * 523.2511 * 2.0 * PI);
+    sample += sin(t * 659.2551 * 2.0 * PI);
+    for (unsigned int c = 0; c < channels; c++) {
+      a.setSampleByFrame(f, c, sample / 3.0);
+    }
+  }
+  return a;
+}
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+double percentile(std::vector<double> values, double p) {
+  if (values.empty()) {
+    return 0.0;
+  }
+  std::sort(values.begin(), values.end());
+  double rank = p * (values.size() - 1);
+  unsigned int below = floor(rank);
+  unsigned int above = ceil(rank);
+  return values[below] + (values[above] - values[below]) * (rank - below);
+}
+
+void print_result(
+  const std::string& benchmark,
+  const std::string& metric,
+  double value,
+  const std::string& unit
+) {
+  printf("{\"benchmark\": \"%s\", \"metric\": \"%s\", \"value\": %.9g, \"unit\": \"%s\"}\n", benchmark.c_str(), metric.c_str(), value, unit.c_str());
+  fflush(stdout);
+}
@@ -0,0 +1,52 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#ifndef BENCHHELPERS_H
+#define BENCHHELPERS_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include "keyfinder/keyfinder.h"
+
+// An A minor triad, continuing from firstFrame so that consecutive packets
+// join up without discontinuities.
+KeyFinder::AudioData synthetic_audio (
+  unsigned int frames,
+  unsigned int channels,
+  unsigned int frameRate,
+  unsigned int firstFrame = 0
+);
+
+double seconds_since(std::chrono::steady_clock::time_point start);
+
+// p in [0, 1]; values need not be sorted
+double percentile(std::vector<double> values, double p);
+
+// One JSON object per line, so results from several runs can be concatenated.
+void print_result(
+  const std::string& benchmark,
+  const std::string& metric,
+  double value,
+  const std::string& unit
+);
+
+#endif // BENCHHELPERS_H
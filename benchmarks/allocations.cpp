@@ -0,0 +1,187 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+/*************************************************************************
+
+  Counts the heap allocations made by an analysis, by replacing the global
+  operator new and delete for this program (and so for the library it
+  loads). Allocations made with malloc directly, such as FFTW's buffers,
+  are not counted.
+
+  Usage: allocations [--no-budgets]
+
+  Reports allocations and bytes per second of audio, and the peak of live
+  heap bytes, for keyOfAudio and for the progressive path at several
+  lengths and packet sizes, then the process's peak RSS. Each scenario is
+  measured after a warm-up run, so one-off setup is excluded. Unless
+  --no-budgets is given, any figure over its budget is reported on stderr
+  and the exit status is non-zero.
+
+*************************************************************************/
+
+#include "_benchhelpers.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+static std::atomic<unsigned long long> allocationCount(0);
+static std::atomic<unsigned long long> allocatedBytes(0);
+static std::atomic<long long> liveBytes(0);
+static std::atomic<long long> peakLiveBytes(0);
+
+// room for the size in front of each block, keeping the default alignment
+static const size_t HEADER = 16;
+
+void* operator new(size_t size) {
+  char* block = (char*)malloc(size + HEADER);
+  if (block == NULL) {
+    throw std::bad_alloc();
+  }
+  memcpy(block, &size, sizeof(size));
+  allocationCount.fetch_add(1, std::memory_order_relaxed);
+  allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+  long long live = liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+  long long peak = peakLiveBytes.load(std::memory_order_relaxed);
+  while (live > peak && !peakLiveBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) { }
+  return block + HEADER;
+}
+
+void operator delete(void* p) noexcept {
+  if (p == NULL) {
+    return;
+  }
+  char* block = (char*)p - HEADER;
+  size_t size;
+  memcpy(&size, block, sizeof(size));
+  liveBytes.fetch_sub(size, std::memory_order_relaxed);
+  free(block);
+}
+
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+
+void operator delete[](void* p) noexcept {
+  operator delete(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+  operator delete(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+  operator delete(p);
+}
+
+class Scenario {
+public:
+  std::string name;
+  unsigned int seconds;
+  unsigned int packetFrames; // 0 for keyOfAudio
+  double allocationsPerSecondBudget;
+  double bytesPerSecondBudget;
+  double peakHeapBudget;
+};
+
+// Budgets are roughly twice the figures measured when they were set, so
+// they only trip on a real regression. Tighten them when allocations are cut.
+static const Scenario SCENARIOS[] = {
+  { "keyOfAudio.10s",       10,    0, 3000.0, 1.6e6, 1.6e7 },
+  { "keyOfAudio.60s",       60,    0, 3000.0, 1.6e6, 9.0e7 },
+  { "progressive.60s.512",  60,  512, 8000.0, 3.6e6, 1.0e6 },
+  { "progressive.60s.4096", 60, 4096, 6000.0, 3.2e6, 1.0e6 },
+};
+
+static unsigned int check(const std::string& name, const char* what, double value, double budget) {
+  if (value <= budget) {
+    return 0;
+  }
+  std::cerr << "OVER BUDGET: " << name << " " << what << " " << value << " (budget " << budget << ")" << std::endl;
+  return 1;
+}
+
+static void run(const Scenario& s, KeyFinder::KeyFinder& k, const KeyFinder::AudioData& audio) {
+  if (s.packetFrames == 0) {
+    k.keyOfAudio(audio);
+    return;
+  }
+  KeyFinder::Workspace w;
+  unsigned int frames = audio.getFrameCount();
+  for (unsigned int first = 0; first < frames; first += s.packetFrames) {
+    KeyFinder::AudioData* packet = audio.copyFrames(first, std::min(s.packetFrames, frames - first));
+    k.progressiveChromagram(*packet, w);
+    delete packet;
+  }
+  k.finalChromagram(w);
+  k.keyOfChromagram(w);
+}
+
+int main(int argc, char** argv) {
+
+  bool budgets = !(argc >= 2 && strcmp(argv[1], "--no-budgets") == 0);
+  unsigned int frameRate = 44100;
+  unsigned int overBudget = 0;
+
+  static KeyFinder::KeyFinder k;
+
+  for (unsigned int i = 0; i < sizeof(SCENARIOS) / sizeof(SCENARIOS[0]); i++) {
+    const Scenario& s = SCENARIOS[i];
+    KeyFinder::AudioData audio = synthetic_audio(s.seconds * frameRate, 2, frameRate);
+    run(s, k, audio);
+
+    unsigned long long allocations = allocationCount.load();
+    unsigned long long bytes = allocatedBytes.load();
+    peakLiveBytes.store(liveBytes.load());
+    long long liveBefore = liveBytes.load();
+
+    run(s, k, audio);
+
+    double perSecond = 1.0 / s.seconds;
+    double allocationsPerSecond = (allocationCount.load() - allocations) * perSecond;
+    double bytesPerSecond = (allocatedBytes.load() - bytes) * perSecond;
+    print_result("allocations", s.name + ".allocations", allocationsPerSecond, "per audio second");
+    print_result("allocations", s.name + ".bytes", bytesPerSecond, "bytes per audio second");
+    print_result("allocations", s.name + ".peakheap", peakLiveBytes.load() - liveBefore, "bytes");
+
+    overBudget += check(s.name, "allocations per audio second", allocationsPerSecond, s.allocationsPerSecondBudget);
+    overBudget += check(s.name, "bytes per audio second", bytesPerSecond, s.bytesPerSecondBudget);
+    overBudget += check(s.name, "peak heap bytes", peakLiveBytes.load() - liveBefore, s.peakHeapBudget);
+  }
+
+#ifndef _WIN32
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  double peakRss = usage.ru_maxrss;          // bytes
+#else
+  double peakRss = usage.ru_maxrss * 1024.0; // kilobytes
+#endif
+  print_result("allocations", "peakrss", peakRss, "bytes");
+#endif
+
+  return (budgets && overBudget > 0) ? 1 : 0;
+}
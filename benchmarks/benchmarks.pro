@@ -0,0 +1,32 @@
+#*************************************************************************
+#
+# Copyright 2011-2015 Ibrahim Sha'ath
+#
+# This file is part of LibKeyFinder.
+#
+# LibKeyFinder is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# LibKeyFinder is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+#
+#*************************************************************************
+
+TEMPLATE = subdirs
+
+SUBDIRS += replay coldstart allocations stages compare training pathological
+
+replay.file = replay.pro
+coldstart.file = coldstart.pro
+allocations.file = allocations.pro
+stages.file = stages.pro
+compare.file = compare.pro
+training.file = training.pro
+pathological.file = pathological.pro
@@ -0,0 +1,163 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+/*************************************************************************
+
+  Measures a fresh process's time to first result, per frame rate. Each
+  measurement runs in its own child process, so nothing is shared between
+  them but the filesystem.
+
+  Usage: coldstart [seconds-of-audio]
+
+  For each frame rate it reports:
+
+  - the one-off setup components, each timed on its own in a fresh process:
+    tone profiles, temporal window, low-pass filter design, chroma kernel
+    construction and FFT planning;
+  - cold.first: the first keyOfAudio call of a fresh process, and
+    cold.warm: a second call in the same process, for comparison;
+  - prewarm.setup and prewarm.first: KeyFinder::prewarm at start-up, then
+    the first call;
+  - wisdom.first: the first call after importing FFTW wisdom measured and
+    exported by an earlier process.
+
+*************************************************************************/
+
+#include "_benchhelpers.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+static const unsigned int FRAME_RATES[] = { 22050, 44100, 48000, 88200, 96000 };
+
+static std::string wisdom_path() {
+  return "coldstart.wisdom";
+}
+
+static void child_components(unsigned int frameRate) {
+  std::string prefix = std::to_string(frameRate) + ".";
+  unsigned int downsampleFactor = KeyFinder::getDownsampleFactor(frameRate);
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  KeyFinder::KeyClassifier classifier(KeyFinder::toneProfileMajor(), KeyFinder::toneProfileMinor());
+  print_result("coldstart", prefix + "component.toneprofiles", seconds_since(start), "s");
+
+  KeyFinder::TemporalWindowFactory twFactory;
+  start = std::chrono::steady_clock::now();
+  twFactory.getTemporalWindow(FFTFRAMESIZE);
+  print_result("coldstart", prefix + "component.window", seconds_since(start), "s");
+
+  KeyFinder::LowPassFilterFactory lpfFactory;
+  start = std::chrono::steady_clock::now();
+  lpfFactory.getLowPassFilter(LPFORDER, frameRate, KeyFinder::getLastFrequency() * 1.012, LPFFFTFRAMESIZE);
+  print_result("coldstart", prefix + "component.lowpassfilter", seconds_since(start), "s");
+
+  KeyFinder::ChromaTransformFactory ctFactory;
+  start = std::chrono::steady_clock::now();
+  ctFactory.getChromaTransform(frameRate / downsampleFactor);
+  print_result("coldstart", prefix + "component.chromakernel", seconds_since(start), "s");
+
+  start = std::chrono::steady_clock::now();
+  KeyFinder::FftAdapter* fft = new KeyFinder::FftAdapter(FFTFRAMESIZE);
+  print_result("coldstart", prefix + "component.fftplan", seconds_since(start), "s");
+  delete fft;
+}
+
+static void child_first_result(unsigned int frameRate, const std::string& mode, double audioSeconds) {
+  std::string prefix = std::to_string(frameRate) + "." + mode + ".";
+  // generated before the clock starts, as a decoder would have done
+  KeyFinder::AudioData audio = synthetic_audio(audioSeconds * frameRate, 2, frameRate);
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  if (mode == "wisdom" && !KeyFinder::importFftWisdom(wisdom_path().c_str())) {
+    std::cerr << "Cannot import " << wisdom_path() << std::endl;
+  }
+  KeyFinder::KeyFinder k;
+  if (mode == "prewarm") {
+    k.prewarm(frameRate);
+  }
+  if (mode != "cold") {
+    print_result("coldstart", prefix + "setup", seconds_since(start), "s");
+  }
+
+  start = std::chrono::steady_clock::now();
+  k.keyOfAudio(audio);
+  print_result("coldstart", prefix + "first", seconds_since(start), "s");
+
+  if (mode == "cold") {
+    start = std::chrono::steady_clock::now();
+    k.keyOfAudio(audio);
+    print_result("coldstart", prefix + "warm", seconds_since(start), "s");
+  }
+}
+
+static void child_export_wisdom() {
+  // estimated plans leave no wisdom behind
+  KeyFinder::setFftPlanMeasuring(true);
+  KeyFinder::KeyFinder k;
+  for (unsigned int i = 0; i < sizeof(FRAME_RATES) / sizeof(FRAME_RATES[0]); i++) {
+    k.prewarm(FRAME_RATES[i]);
+  }
+  if (!KeyFinder::exportFftWisdom(wisdom_path().c_str())) {
+    std::cerr << "Cannot export " << wisdom_path() << std::endl;
+  }
+}
+
+static int spawn(const char* self, const std::string& arguments) {
+  std::ostringstream command;
+  command << "\"" << self << "\" --child " << arguments;
+  fflush(stdout);
+  return system(command.str().c_str());
+}
+
+int main(int argc, char** argv) {
+
+  if (argc >= 3 && strcmp(argv[1], "--child") == 0) {
+    std::string task = argv[2];
+    if (task == "export") {
+      child_export_wisdom();
+    } else if (task == "components" && argc >= 4) {
+      child_components(atoi(argv[3]));
+    } else if (argc >= 5) {
+      child_first_result(atoi(argv[3]), task, atof(argv[4]));
+    }
+    return 0;
+  }
+
+  double audioSeconds = argc >= 2 ? atof(argv[1]) : 10.0;
+  const char* modes[] = { "cold", "prewarm", "wisdom" };
+
+  int failures = spawn(argv[0], "export");
+  for (unsigned int i = 0; i < sizeof(FRAME_RATES) / sizeof(FRAME_RATES[0]); i++) {
+    std::string rate = std::to_string(FRAME_RATES[i]);
+    failures += spawn(argv[0], "components " + rate);
+    for (unsigned int m = 0; m < 3; m++) {
+      failures += spawn(argv[0], std::string(modes[m]) + " " + rate + " " + std::to_string(audioSeconds));
+    }
+  }
+  remove(wisdom_path().c_str());
+
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,298 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+/*************************************************************************
+
+  Runs a benchmark repeatedly and compares its results with a baseline,
+  using a Mann-Whitney U test on the per-trial values of each metric.
+
+  Usage:
+    compare [options] --record baseline.jsonl benchmark [arguments...]
+    compare [options] --baseline baseline.jsonl benchmark [arguments...]
+    compare [options] --baseline baseline.jsonl --candidate results.jsonl
+
+  Options:
+    --trials N       runs of the benchmark (default 10)
+    --alpha A        significance level (default 0.05)
+    --threshold P    smallest change, in percent, worth flagging (default 1)
+
+  Each trial's output is kept, one JSON object per line with a "trial"
+  field added, so a recorded baseline can be committed and later runs
+  compared against it. Metrics measured in seconds, bytes or allocations
+  are better when lower; throughput ("x realtime") is better when higher;
+  plain counts are not compared. The exit status is non-zero if any metric
+  regressed significantly.
+
+*************************************************************************/
+
+#include "_benchhelpers.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#endif
+
+class Samples {
+public:
+  std::string unit;
+  std::vector<double> values;
+};
+
+typedef std::map<std::string, Samples> Results;
+
+static std::string field(const std::string& line, const std::string& name) {
+  std::string key = "\"" + name + "\": ";
+  size_t start = line.find(key);
+  if (start == std::string::npos) {
+    return "";
+  }
+  start += key.size();
+  if (line[start] == '"') {
+    size_t end = line.find('"', start + 1);
+    return line.substr(start + 1, end - start - 1);
+  }
+  size_t end = line.find_first_of(",}", start);
+  return line.substr(start, end - start);
+}
+
+// Lines that aren't benchmark results are ignored.
+static bool add_line(const std::string& line, Results& results) {
+  std::string benchmark = field(line, "benchmark");
+  std::string metric = field(line, "metric");
+  std::string value = field(line, "value");
+  if (benchmark.empty() || metric.empty() || value.empty()) {
+    return false;
+  }
+  Samples& s = results[benchmark + "/" + metric];
+  s.unit = field(line, "unit");
+  s.values.push_back(atof(value.c_str()));
+  return true;
+}
+
+static bool load(const char* path, Results& results) {
+  std::ifstream in(path);
+  if (!in) {
+    std::cerr << "Cannot open " << path << std::endl;
+    return false;
+  }
+  std::string line;
+  while (std::getline(in, line)) {
+    add_line(line, results);
+  }
+  return true;
+}
+
+static bool run_trials(const std::string& command, unsigned int trials, Results& results, std::ostream* record) {
+  for (unsigned int t = 0; t < trials; t++) {
+    std::cerr << "trial " << (t + 1) << "/" << trials << ": " << command << std::endl;
+    FILE* pipe = popen(command.c_str(), "r");
+    if (pipe == NULL) {
+      std::cerr << "Cannot run " << command << std::endl;
+      return false;
+    }
+    char buffer[4096];
+    while (fgets(buffer, sizeof(buffer), pipe) != NULL) {
+      std::string line(buffer);
+      while (!line.empty() && (line[line.size() - 1] == '\n' || line[line.size() - 1] == '\r')) {
+        line.erase(line.size() - 1);
+      }
+      if (add_line(line, results) && record != NULL) {
+        *record << line.substr(0, line.rfind('}')) << ", \"trial\": " << t << "}\n";
+      }
+    }
+    // a benchmark that fails its own budgets still produces comparable figures
+    pclose(pipe);
+  }
+  return true;
+}
+
+// P(U <= u) for samples of sizes m and n with no ties, by counting the
+// arrangements of the combined ranks that give each value of U.
+static double exact_cdf(unsigned int m, unsigned int n, double u) {
+  std::vector< std::vector< std::vector<double> > > ways(m + 1, std::vector< std::vector<double> >(n + 1));
+  for (unsigned int i = 0; i <= m; i++) {
+    for (unsigned int j = 0; j <= n; j++) {
+      ways[i][j].assign(i * j + 1, 0.0);
+      if (i == 0 || j == 0) {
+        ways[i][j][0] = 1.0;
+        continue;
+      }
+      for (unsigned int k = 0; k <= i * j; k++) {
+        // the largest value is from the first sample (beating all j of the
+        // second) or from the second
+        if (k >= j) {
+          ways[i][j][k] += ways[i - 1][j][k - j];
+        }
+        if (k <= i * (j - 1)) {
+          ways[i][j][k] += ways[i][j - 1][k];
+        }
+      }
+    }
+  }
+  double total = 0.0;
+  double below = 0.0;
+  for (unsigned int k = 0; k <= m * n; k++) {
+    total += ways[m][n][k];
+    if (k <= u + 1.0e-9) {
+      below += ways[m][n][k];
+    }
+  }
+  return below / total;
+}
+
+static double normal_cdf(double z) {
+  return 0.5 * erfc(-z / sqrt(2.0));
+}
+
+// Two-sided p-value of the Mann-Whitney U test.
+static double mann_whitney(const std::vector<double>& a, const std::vector<double>& b) {
+  unsigned int m = a.size();
+  unsigned int n = b.size();
+  std::vector< std::pair<double, unsigned int> > all;
+  for (unsigned int i = 0; i < m; i++) all.push_back(std::make_pair(a[i], 0));
+  for (unsigned int i = 0; i < n; i++) all.push_back(std::make_pair(b[i], 1));
+  std::sort(all.begin(), all.end());
+
+  // mid-ranks for ties, and the tie correction for the variance
+  double rankSumA = 0.0;
+  double tieTerm = 0.0;
+  bool ties = false;
+  for (unsigned int i = 0; i < all.size(); ) {
+    unsigned int j = i;
+    while (j < all.size() && all[j].first == all[i].first) j++;
+    double rank = (i + j + 1) / 2.0;
+    double t = j - i;
+    if (t > 1) {
+      ties = true;
+      tieTerm += t * t * t - t;
+    }
+    for (unsigned int k = i; k < j; k++) {
+      if (all[k].second == 0) rankSumA += rank;
+    }
+    i = j;
+  }
+  double u = rankSumA - m * (m + 1) / 2.0;
+
+  if (!ties && m + n <= 40) {
+    double lower = exact_cdf(m, n, u);
+    double upper = 1.0 - exact_cdf(m, n, u - 1.0);
+    return std::min(1.0, 2.0 * std::min(lower, upper));
+  }
+  double N = m + n;
+  double mean = m * n / 2.0;
+  double variance = m * n / 12.0 * ((N + 1) - tieTerm / (N * (N - 1)));
+  if (variance <= 0.0) {
+    return 1.0;
+  }
+  double z = (fabs(u - mean) - 0.5) / sqrt(variance);
+  return std::min(1.0, 2.0 * (1.0 - normal_cdf(std::max(0.0, z))));
+}
+
+static int compare(const Results& baseline, const Results& candidate, double alpha, double threshold) {
+  unsigned int regressions = 0;
+  printf("%-48s %12s %12s %8s %8s  %s\n", "metric", "baseline", "candidate", "change", "p", "verdict");
+  for (Results::const_iterator it = candidate.begin(); it != candidate.end(); ++it) {
+    const Samples& c = it->second;
+    Results::const_iterator b = baseline.find(it->first);
+    if (b == baseline.end() || c.unit == "count") {
+      continue;
+    }
+    double before = percentile(b->second.values, 0.5);
+    double after = percentile(c.values, 0.5);
+    double change = before != 0.0 ? (after - before) / fabs(before) * 100.0 : 0.0;
+    double p = mann_whitney(b->second.values, c.values);
+    bool higherIsBetter = (c.unit == "x realtime");
+    std::string verdict = "-";
+    if (p < alpha && fabs(change) >= threshold) {
+      bool worse = higherIsBetter ? change < 0.0 : change > 0.0;
+      verdict = worse ? "REGRESSION" : "improvement";
+      if (worse) regressions++;
+    }
+    printf("%-48s %12.6g %12.6g %+7.2f%% %8.4f  %s\n", it->first.c_str(), before, after, change, p, verdict.c_str());
+  }
+  return regressions > 0 ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+
+  unsigned int trials = 10;
+  double alpha = 0.05;
+  double threshold = 1.0;
+  const char* recordPath = NULL;
+  const char* baselinePath = NULL;
+  const char* candidatePath = NULL;
+  std::string command;
+
+  int i = 1;
+  for (; i < argc && argv[i][0] == '-'; i++) {
+    std::string option = argv[i];
+    if (i + 1 >= argc) {
+      std::cerr << "Missing value for " << option << std::endl;
+      return 2;
+    }
+    if (option == "--trials") trials = atoi(argv[++i]);
+    else if (option == "--alpha") alpha = atof(argv[++i]);
+    else if (option == "--threshold") threshold = atof(argv[++i]);
+    else if (option == "--record") recordPath = argv[++i];
+    else if (option == "--baseline") baselinePath = argv[++i];
+    else if (option == "--candidate") candidatePath = argv[++i];
+    else {
+      std::cerr << "Unknown option " << option << std::endl;
+      return 2;
+    }
+  }
+  for (; i < argc; i++) {
+    command += (command.empty() ? "\"" : " \"") + std::string(argv[i]) + "\"";
+  }
+  if ((recordPath == NULL) == (baselinePath == NULL) || (command.empty() && candidatePath == NULL) || trials < 1) {
+    std::cerr << "Usage: compare [--trials N] [--alpha A] [--threshold P] (--record FILE | --baseline FILE) (--candidate FILE | benchmark [arguments...])" << std::endl;
+    return 2;
+  }
+
+  if (recordPath != NULL) {
+    std::ofstream record(recordPath);
+    Results results;
+    return run_trials(command, trials, results, &record) ? 0 : 1;
+  }
+
+  Results baseline;
+  Results candidate;
+  if (!load(baselinePath, baseline)) {
+    return 2;
+  }
+  if (candidatePath != NULL) {
+    if (!load(candidatePath, candidate)) {
+      return 2;
+    }
+  } else if (!run_trials(command, trials, candidate, NULL)) {
+    return 2;
+  }
+  return compare(baseline, candidate, alpha, threshold);
+}
@@ -0,0 +1,176 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+/*************************************************************************
+
+  Times the input shapes that reach the library's slow paths: packets of
+  a few samples, which push the remainder buffer through prepend and
+  slice on every call; 384kHz input, with its large downsampling factor;
+  eight channels to reduce to mono; and long silence, a DC offset and
+  denormal-range samples, which stress the filter arithmetic.
+
+  Usage: pathological [--no-targets] [case-name-prefix]
+
+  For each case, reports throughput as a multiple of real time and the
+  99th percentile and maximum latency of a single library call, after a
+  warm-up run. Targets apply to throughput and the 99th percentile.
+  Unless --no-targets is given, a case below its throughput target or
+  above its latency target is reported on stderr and the exit status is
+  non-zero.
+
+*************************************************************************/
+
+#include "_benchhelpers.h"
+
+#include <cstring>
+#include <iostream>
+
+enum signal_t {
+  SIGNAL_TRIAD,
+  SIGNAL_SILENCE,
+  SIGNAL_DC_OFFSET,
+  SIGNAL_DENORMAL
+};
+
+class Case {
+public:
+  std::string name;
+  unsigned int frameRate;
+  unsigned int channels;
+  double seconds;
+  unsigned int packetFrames; // 0 for keyOfAudio
+  signal_t signal;
+  double minRealtime;        // audio seconds per second of calls
+  double maxCallP99;         // seconds
+};
+
+// Targets are roughly half the throughput and twice the latency measured
+// when they were set, so they only trip on a real regression. Tighten
+// them when a slow path is fixed.
+static const Case CASES[] = {
+  { "packets.1",       44100, 2,   2.0,    1, SIGNAL_TRIAD,        8.0, 1.0e-5 },
+  { "packets.3",       44100, 2,   5.0,    3, SIGNAL_TRIAD,       20.0, 1.0e-5 },
+  { "packets.10",      44100, 2,  10.0,   10, SIGNAL_TRIAD,       70.0, 1.0e-5 },
+  { "rate.384k",      384000, 2,  10.0,    0, SIGNAL_TRIAD,       35.0, 0.3 },
+  { "rate.384k.4096", 384000, 2,  10.0, 4096, SIGNAL_TRIAD,       60.0, 1.0e-3 },
+  { "channels.8",      48000, 8,  10.0,    0, SIGNAL_TRIAD,      130.0, 0.08 },
+  { "silence.600s",    44100, 2, 600.0,    0, SIGNAL_SILENCE,    180.0, 3.5 },
+  { "dcoffset",        44100, 2,  30.0,    0, SIGNAL_DC_OFFSET,  200.0, 0.15 },
+  // about twenty times slower than dcoffset when the targets were set
+  { "denormal",        44100, 2,  30.0,    0, SIGNAL_DENORMAL,     9.0, 3.2 },
+};
+
+static KeyFinder::AudioData signal_of(const Case& c) {
+  unsigned int frames = c.seconds * c.frameRate;
+  if (c.signal == SIGNAL_SILENCE) {
+    KeyFinder::AudioData a;
+    a.setChannels(c.channels);
+    a.setFrameRate(c.frameRate);
+    a.addToFrameCount(frames);
+    return a;
+  }
+  KeyFinder::AudioData a = synthetic_audio(frames, c.channels, c.frameRate);
+  for (size_t i = 0; i < a.getSampleCount(); i++) {
+    if (c.signal == SIGNAL_DC_OFFSET) {
+      a.setSample(i, 0.9 + a.getSample(i) * 0.05);
+    } else if (c.signal == SIGNAL_DENORMAL) {
+      a.setSample(i, a.getSample(i) * 1e-310);
+    }
+  }
+  return a;
+}
+
+// the duration of each library call
+static std::vector<double> run(const Case& c, KeyFinder::KeyFinder& k, const KeyFinder::AudioData& audio) {
+  std::vector<double> calls;
+  std::chrono::steady_clock::time_point start;
+  if (c.packetFrames == 0) {
+    start = std::chrono::steady_clock::now();
+    k.keyOfAudio(audio);
+    calls.push_back(seconds_since(start));
+    return calls;
+  }
+  KeyFinder::Workspace w;
+  size_t frames = audio.getFrameCount();
+  for (size_t first = 0; first < frames; first += c.packetFrames) {
+    KeyFinder::AudioData* packet = audio.copyFrames(first, std::min<size_t>(c.packetFrames, frames - first));
+    start = std::chrono::steady_clock::now();
+    k.progressiveChromagram(*packet, w);
+    calls.push_back(seconds_since(start));
+    delete packet;
+  }
+  start = std::chrono::steady_clock::now();
+  k.finalChromagram(w);
+  k.keyOfChromagram(w);
+  calls.push_back(seconds_since(start));
+  return calls;
+}
+
+static unsigned int check(const std::string& name, const char* what, double value, double target, bool atLeast) {
+  if (atLeast ? value >= target : value <= target) {
+    return 0;
+  }
+  std::cerr << "MISSED TARGET: " << name << " " << what << " " << value << " (target " << (atLeast ? ">= " : "<= ") << target << ")" << std::endl;
+  return 1;
+}
+
+int main(int argc, char** argv) {
+
+  bool targets = true;
+  std::string prefix;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--no-targets") == 0) {
+      targets = false;
+    } else {
+      prefix = argv[i];
+    }
+  }
+
+  static KeyFinder::KeyFinder k;
+  unsigned int missed = 0;
+
+  for (unsigned int i = 0; i < sizeof(CASES) / sizeof(CASES[0]); i++) {
+    const Case& c = CASES[i];
+    if (c.name.compare(0, prefix.size(), prefix) != 0) {
+      continue;
+    }
+    KeyFinder::AudioData audio = signal_of(c);
+    KeyFinder::AudioData* warmUp = audio.copyFrames(0, std::min<size_t>(audio.getFrameCount(), c.frameRate));
+    run(c, k, *warmUp);
+    delete warmUp;
+
+    std::vector<double> calls = run(c, k, audio);
+    double total = 0.0;
+    for (unsigned int j = 0; j < calls.size(); j++) {
+      total += calls[j];
+    }
+    double realtime = c.seconds / total;
+    double p99 = percentile(calls, 0.99);
+    print_result("pathological", c.name + ".realtime", realtime, "x");
+    print_result("pathological", c.name + ".callp99", p99, "s");
+    print_result("pathological", c.name + ".callmax", *std::max_element(calls.begin(), calls.end()), "s");
+
+    missed += check(c.name, "throughput", realtime, c.minRealtime, true);
+    missed += check(c.name, "call p99", p99, c.maxCallP99, false);
+  }
+
+  return (targets && missed > 0) ? 1 : 0;
+}
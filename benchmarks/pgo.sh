@@ -0,0 +1,39 @@
+#!/bin/sh
+# Builds the library with link-time and profile-guided optimisation: an
+# instrumented build, a run of the training workload against it, and then
+# the optimised build, which is left in the source tree ready for
+# "make install". Run from the root of the source tree.
+set -e
+
+ROOT="$(pwd -P)"
+PGO_DIR="$ROOT/pgo"
+TRAINING="$ROOT/build-training"
+
+rm -rf "$PGO_DIR" "$TRAINING"
+
+echo Building instrumented library
+qmake "CONFIG+=release lto pgo-generate" "PGO_DIR=$PGO_DIR"
+make clean
+make
+
+echo Building training workload
+mkdir -p "$TRAINING/include"
+ln -s "$ROOT" "$TRAINING/include/keyfinder"
+cd "$TRAINING"
+qmake "$ROOT/benchmarks/training.pro" "INCLUDEPATH+=$TRAINING/include" "LIBS+=-L$ROOT"
+make
+cd "$ROOT"
+
+echo Training
+LD_LIBRARY_PATH="$ROOT" DYLD_LIBRARY_PATH="$ROOT" "$TRAINING/training" "${TRAINING_SCALE:-1}"
+
+case "$(qmake -query QMAKE_SPEC)" in
+  *clang*)
+    llvm-profdata merge -o "$PGO_DIR/default.profdata" "$PGO_DIR"/*.profraw
+    ;;
+esac
+
+echo Building optimised library
+make clean
+qmake "CONFIG+=release lto pgo-use" "PGO_DIR=$PGO_DIR"
+make
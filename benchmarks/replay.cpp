@@ -0,0 +1,169 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+/*************************************************************************
+
+  Replays a streaming workload trace, as written by WorkloadRecorder,
+  against the library with synthetic audio of the same shape.
+
+  Usage: replay [--paced] [trace-file]
+
+  --paced waits until each call's recorded start time rather than issuing
+  calls back to back. Without a trace file, a default pattern is used: 60
+  seconds of 44.1kHz stereo in 512-frame packets, with a key estimate
+  requested every 10 packets.
+
+*************************************************************************/
+
+#include "_benchhelpers.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <thread>
+
+static std::vector<KeyFinder::WorkloadEvent> default_workload() {
+  std::vector<KeyFinder::WorkloadEvent> events;
+  unsigned int packets = 60 * 44100 / 512;
+  for (unsigned int i = 0; i < packets; i++) {
+    KeyFinder::WorkloadEvent e;
+    e.call = KeyFinder::CALL_PROGRESSIVE_CHROMAGRAM;
+    e.frames = 512;
+    e.channels = 2;
+    e.frameRate = 44100;
+    e.startSeconds = i * 512 / 44100.0;
+    e.durationSeconds = 0.0;
+    events.push_back(e);
+    if (i % 10 == 9) {
+      e.call = KeyFinder::CALL_KEY_OF_CHROMAGRAM;
+      events.push_back(e);
+    }
+  }
+  KeyFinder::WorkloadEvent e = events.back();
+  e.call = KeyFinder::CALL_FINAL_CHROMAGRAM;
+  events.push_back(e);
+  return events;
+}
+
+int main(int argc, char** argv) {
+
+  bool paced = false;
+  const char* tracePath = NULL;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--paced") == 0) {
+      paced = true;
+    } else {
+      tracePath = argv[i];
+    }
+  }
+
+  std::vector<KeyFinder::WorkloadEvent> events;
+  if (tracePath != NULL) {
+    std::ifstream trace(tracePath);
+    if (!trace) {
+      std::cerr << "Cannot open " << tracePath << std::endl;
+      return 1;
+    }
+    KeyFinder::WorkloadRecorder recorder;
+    recorder.read(trace);
+    events = recorder.getEvents();
+  } else {
+    events = default_workload();
+  }
+
+  static KeyFinder::KeyFinder k;
+  KeyFinder::Workspace* w = new KeyFinder::Workspace();
+
+  const char* names[] = { "progressive", "final", "key", "analysisrate", "spectra" };
+  std::map<int, std::vector<double> > latencies;
+  double audioSeconds = 0.0;
+  unsigned int framePosition = 0;
+
+  std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+  for (unsigned int i = 0; i < events.size(); i++) {
+    const KeyFinder::WorkloadEvent& e = events[i];
+    if (paced) {
+      std::this_thread::sleep_until(origin + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(e.startSeconds)));
+    }
+    KeyFinder::AudioData packet;
+    std::vector< std::vector<double> > spectra;
+    // generated outside the timed region
+    if (e.call == KeyFinder::CALL_PROGRESSIVE_CHROMAGRAM || e.call == KeyFinder::CALL_ANALYSIS_RATE_CHROMAGRAM) {
+      packet = synthetic_audio(e.frames, e.channels, e.frameRate, framePosition);
+      framePosition += e.frames;
+      audioSeconds += e.frames / (double)e.frameRate;
+    } else if (e.call == KeyFinder::CALL_SPECTRA_CHROMAGRAM) {
+      spectra.assign(e.frames, std::vector<double>(e.frameSize / 2 + 1, 0.0));
+      for (unsigned int f = 0; f < spectra.size(); f++) {
+        for (unsigned int bin = 0; bin < spectra[f].size(); bin++) {
+          spectra[f][bin] = 1.0 / (1.0 + (bin + f) % 97);
+        }
+      }
+      // the hop of the caller's STFT isn't recorded, so spectra don't count towards throughput
+    }
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    switch (e.call) {
+      case KeyFinder::CALL_PROGRESSIVE_CHROMAGRAM:
+        k.progressiveChromagram(packet, *w);
+        break;
+      case KeyFinder::CALL_FINAL_CHROMAGRAM:
+        k.finalChromagram(*w);
+        break;
+      case KeyFinder::CALL_KEY_OF_CHROMAGRAM:
+        if (w->chromagram != NULL) {
+          k.keyOfChromagram(*w);
+        }
+        break;
+      case KeyFinder::CALL_ANALYSIS_RATE_CHROMAGRAM:
+        k.progressiveChromagramAtAnalysisRate(packet, *w);
+        break;
+      case KeyFinder::CALL_SPECTRA_CHROMAGRAM:
+        k.progressiveChromagramOfSpectra(spectra, e.frameSize, e.frameRate, *w);
+        break;
+    }
+    latencies[e.call].push_back(seconds_since(start));
+    if (e.call == KeyFinder::CALL_FINAL_CHROMAGRAM) {
+      // a finished stream; the next call starts a new one
+      delete w;
+      w = new KeyFinder::Workspace();
+      framePosition = 0;
+    }
+  }
+  delete w;
+
+  double busySeconds = 0.0;
+  for (std::map<int, std::vector<double> >::const_iterator it = latencies.begin(); it != latencies.end(); ++it) {
+    std::string name = names[it->first];
+    const std::vector<double>& l = it->second;
+    for (unsigned int i = 0; i < l.size(); i++) {
+      busySeconds += l[i];
+    }
+    print_result("replay", name + ".calls", l.size(), "count");
+    print_result("replay", name + ".p50", percentile(l, 0.5), "s");
+    print_result("replay", name + ".p99", percentile(l, 0.99), "s");
+    print_result("replay", name + ".p999", percentile(l, 0.999), "s");
+    print_result("replay", name + ".max", percentile(l, 1.0), "s");
+  }
+  print_result("replay", "throughput", busySeconds > 0.0 ? audioSeconds / busySeconds : 0.0, "x realtime");
+
+  return 0;
+}
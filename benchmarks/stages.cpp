@@ -0,0 +1,98 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+/*************************************************************************
+
+  Times each stage of a whole-file analysis on its own, so that a change
+  in one stage is not lost in the noise of the others.
+
+  Usage: stages [seconds-of-audio] [repetitions]
+
+  Reports the median over the repetitions of: reduction to mono, low-pass
+  filtering, downsampling, spectral analysis into a chromagram, and key
+  classification, and of keyOfAudio as a whole. Run it under compare to
+  test each stage against a baseline.
+
+*************************************************************************/
+
+#include "_benchhelpers.h"
+
+#include <cmath>
+#include <cstdlib>
+
+int main(int argc, char** argv) {
+
+  double seconds = argc >= 2 ? atof(argv[1]) : 30.0;
+  unsigned int repetitions = argc >= 3 ? atoi(argv[2]) : 5;
+  unsigned int frameRate = 44100;
+  unsigned int downsampleFactor = KeyFinder::getDownsampleFactor(frameRate);
+
+  KeyFinder::AudioData original = synthetic_audio(seconds * frameRate, 2, frameRate);
+
+  static KeyFinder::KeyFinder k;
+  KeyFinder::LowPassFilterFactory lpfFactory;
+  KeyFinder::ChromaTransformFactory ctFactory;
+  KeyFinder::TemporalWindowFactory twFactory;
+  std::shared_ptr<const KeyFinder::LowPassFilter> lpf = lpfFactory.getLowPassFilter(LPFORDER, frameRate, KeyFinder::getLastFrequency() * 1.012, LPFFFTFRAMESIZE);
+  KeyFinder::SpectrumAnalyser sa(frameRate / downsampleFactor, &ctFactory, &twFactory);
+  KeyFinder::KeyClassifier classifier(KeyFinder::toneProfileMajor(), KeyFinder::toneProfileMinor());
+  k.keyOfAudio(original); // warm-up
+
+  const char* names[] = { "mono", "lowpass", "downsample", "spectrum", "classify", "keyOfAudio" };
+  std::vector< std::vector<double> > times(6);
+
+  for (unsigned int r = 0; r < repetitions; r++) {
+    KeyFinder::AudioData audio = original;
+    KeyFinder::Workspace w;
+    w.fftAdapter = new KeyFinder::FftAdapter(FFTFRAMESIZE);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    audio.reduceToMono();
+    times[0].push_back(seconds_since(start));
+
+    start = std::chrono::steady_clock::now();
+    lpf->filter(audio, w, downsampleFactor);
+    times[1].push_back(seconds_since(start));
+
+    start = std::chrono::steady_clock::now();
+    audio.downsample(downsampleFactor);
+    times[2].push_back(seconds_since(start));
+
+    start = std::chrono::steady_clock::now();
+    KeyFinder::Chromagram* c = sa.chromagramOfWholeFrames(audio, w.fftAdapter);
+    times[3].push_back(seconds_since(start));
+
+    start = std::chrono::steady_clock::now();
+    classifier.classify(c->collapseToOneHop());
+    times[4].push_back(seconds_since(start));
+    delete c;
+
+    start = std::chrono::steady_clock::now();
+    k.keyOfAudio(original);
+    times[5].push_back(seconds_since(start));
+  }
+
+  for (unsigned int s = 0; s < times.size(); s++) {
+    print_result("stages", names[s], percentile(times[s], 0.5), "s");
+  }
+
+  return 0;
+}
@@ -0,0 +1,113 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+/*************************************************************************
+
+  The training workload for profile-guided builds of the library (see
+  pgo.sh). It drives synthetic audio through each of the main paths, at
+  the common frame rates and channel counts, in roughly the proportions a
+  real application would: mostly whole-file analysis and streaming, with
+  some region, peek, per-channel, stacked-profile and cached analyses.
+
+  Usage: training [scale]
+
+  scale multiplies the amount of audio analysed (default 1, a little over
+  twenty minutes of audio in all).
+
+*************************************************************************/
+
+#include "_benchhelpers.h"
+
+#include <cstdlib>
+
+static const unsigned int FRAME_RATES[] = { 22050, 44100, 48000, 96000 };
+
+int main(int argc, char** argv) {
+
+  double scale = argc >= 2 ? atof(argv[1]) : 1.0;
+  unsigned int seconds = (unsigned int)(20 * scale);
+  if (seconds < 1) {
+    seconds = 1;
+  }
+
+  static KeyFinder::KeyFinder k;
+  std::vector<KeyFinder::ToneProfileSet> profileSets;
+  profileSets.push_back(KeyFinder::ToneProfileSet(KeyFinder::toneProfileMajor(), KeyFinder::toneProfileMinor()));
+  profileSets.push_back(KeyFinder::ToneProfileSet(KeyFinder::toneProfileMinor(), KeyFinder::toneProfileMajor()));
+  KeyFinder::StackedKeyClassifier stacked(profileSets);
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  double audioSeconds = 0.0;
+
+  for (unsigned int r = 0; r < sizeof(FRAME_RATES) / sizeof(FRAME_RATES[0]); r++) {
+    unsigned int frameRate = FRAME_RATES[r];
+    for (unsigned int channels = 1; channels <= 2; channels++) {
+      KeyFinder::AudioData audio = synthetic_audio(seconds * frameRate, channels, frameRate);
+
+      // whole files; the diagnostics also give the downsample factor
+      KeyFinder::AnalysisDiagnostics diagnostics;
+      k.keyOfAudio(audio, diagnostics);
+      k.keyOfAudio(audio, stacked);
+      k.keyOfRegion(audio, seconds / 4.0, seconds * 3 / 4.0);
+      audioSeconds += 2.5 * seconds;
+
+      // streams, in small and large packets
+      unsigned int packetSizes[] = { 512, 4096 };
+      for (unsigned int p = 0; p < 2; p++) {
+        KeyFinder::Workspace w;
+        for (unsigned int first = 0; first < audio.getFrameCount(); first += packetSizes[p]) {
+          KeyFinder::AudioData* packet = audio.copyFrames(first, std::min<size_t>(packetSizes[p], audio.getFrameCount() - first));
+          k.progressiveChromagram(*packet, w);
+          delete packet;
+          if ((first / packetSizes[p]) % 50 == 49) {
+            k.keyOfChromagram(w);
+            k.peekKey(w);
+          }
+        }
+        k.finalChromagram(w);
+        k.keyOfChromagram(w);
+        audioSeconds += seconds;
+      }
+
+      if (channels == 2) {
+        k.keyOfChannels(audio, KeyFinder::CHANNELS_SEPARATE);
+        k.keyOfChannels(audio, KeyFinder::CHANNELS_MID_SIDE);
+        audioSeconds += 5 * seconds;
+      }
+
+      // re-analysis with a hop cache; the tail starts on a hop boundary of
+      // the first pass, so all but its first few hops hit
+      KeyFinder::HopCache cache;
+      k.keyOfAudio(audio, cache);
+      size_t framesPerHop = (size_t)diagnostics.downsampleFactor * HOPSIZE;
+      size_t tailStart = audio.getFrameCount() / 2 / framesPerHop * framesPerHop;
+      KeyFinder::AudioData* tail = audio.copyFrames(tailStart, audio.getFrameCount() - tailStart);
+      k.keyOfAudio(*tail, cache);
+      delete tail;
+      audioSeconds += 1.5 * seconds;
+    }
+  }
+
+  print_result("training", "audio", audioSeconds, "s");
+  print_result("training", "elapsed", seconds_since(start), "s");
+
+  return 0;
+}
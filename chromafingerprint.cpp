@@ -0,0 +1,192 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#include "chromafingerprint.h"
+#include <map>
+
+namespace KeyFinder {
+
+  static const unsigned int FINGERPRINT_BITS = SEMITONES * 2 + OCTAVES - 1;
+
+  // alignments scored per query, after voting
+  static const unsigned int MAX_CANDIDATES = 16;
+
+  ChromaFingerprint::ChromaFingerprint() : words(), previousClasses(), previousOctaves() { }
+
+  void ChromaFingerprint::append(const Chromagram& chromagram) {
+    std::vector<double> classes(SEMITONES);
+    std::vector<double> octaves(OCTAVES);
+    for (size_t hop = 0; hop < chromagram.getHops(); hop++) {
+
+      std::fill(classes.begin(), classes.end(), 0.0);
+      std::fill(octaves.begin(), octaves.end(), 0.0);
+      for (unsigned int band = 0; band < BANDS; band++) {
+        double magnitude = chromagram.getMagnitude(hop, band);
+        classes[band % SEMITONES] += magnitude;
+        octaves[band / SEMITONES] += magnitude;
+      }
+
+      if (!previousClasses.empty()) {
+        std::vector<double> sorted(classes);
+        std::nth_element(sorted.begin(), sorted.begin() + SEMITONES / 2, sorted.end());
+        double median = sorted[SEMITONES / 2];
+
+        unsigned int word = 0;
+        for (unsigned int s = 0; s < SEMITONES; s++) {
+          unsigned int next = (s + 1) % SEMITONES;
+          double now = classes[s] - classes[next];
+          double before = previousClasses[s] - previousClasses[next];
+          if (now - before > 0.0) {
+            word |= 1u << s;
+          }
+          if (classes[s] > median) {
+            word |= 1u << (SEMITONES + s);
+          }
+        }
+        for (unsigned int o = 0; o + 1 < OCTAVES; o++) {
+          double now = octaves[o] - octaves[o + 1];
+          double before = previousOctaves[o] - previousOctaves[o + 1];
+          if (now - before > 0.0) {
+            word |= 1u << (SEMITONES * 2 + o);
+          }
+        }
+        words.push_back(word);
+      }
+      previousClasses = classes;
+      previousOctaves = octaves;
+    }
+  }
+
+  const std::vector<unsigned int>& ChromaFingerprint::getWords() const {
+    return words;
+  }
+
+  size_t ChromaFingerprint::size() const {
+    return words.size();
+  }
+
+  unsigned int ChromaFingerprint::hammingDistance(unsigned int a, unsigned int b) {
+    unsigned int x = a ^ b;
+    x = x - ((x >> 1) & 0x55555555u);
+    x = (x & 0x33333333u) + ((x >> 2) & 0x33333333u);
+    return (((x + (x >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24;
+  }
+
+  static bool closerMatch(const FingerprintMatch& a, const FingerprintMatch& b) {
+    return a.bitErrorRate < b.bitErrorRate;
+  }
+
+  FingerprintIndex::FingerprintIndex() : fingerprints(), postings() { }
+
+  void FingerprintIndex::add(unsigned int id, const ChromaFingerprint& fingerprint) {
+    if (fingerprints.count(id) > 0) {
+      std::ostringstream ss;
+      ss << "Fingerprint " << id << " is already indexed";
+      throw Exception(ss.str().c_str());
+    }
+    const std::vector<unsigned int>& words = fingerprint.getWords();
+    fingerprints[id] = words;
+    for (size_t position = 0; position < words.size(); position++) {
+      // silence gives all-zero words, which would match everything
+      if (words[position] != 0) {
+        postings[words[position]].push_back(std::make_pair(id, position));
+      }
+    }
+  }
+
+  std::vector<FingerprintMatch> FingerprintIndex::match(const ChromaFingerprint& query, double maxBitErrorRate) const {
+
+    const std::vector<unsigned int>& queryWords = query.getWords();
+
+    // votes for each (id, offset) alignment
+    std::map< std::pair<unsigned int, long long>, unsigned int > votes;
+    for (size_t q = 0; q < queryWords.size(); q++) {
+      if (queryWords[q] == 0) {
+        continue;
+      }
+      for (unsigned int flip = 0; flip <= FINGERPRINT_BITS; flip++) {
+        unsigned int word = flip < FINGERPRINT_BITS ? queryWords[q] ^ (1u << flip) : queryWords[q];
+        std::unordered_map< unsigned int, std::vector< std::pair<unsigned int, size_t> > >::const_iterator found = postings.find(word);
+        if (found == postings.end()) {
+          continue;
+        }
+        for (unsigned int p = 0; p < found->second.size(); p++) {
+          long long offset = (long long)found->second[p].second - (long long)q;
+          votes[std::make_pair(found->second[p].first, offset)]++;
+        }
+      }
+    }
+
+    std::vector< std::pair<unsigned int, std::pair<unsigned int, long long> > > candidates;
+    for (std::map< std::pair<unsigned int, long long>, unsigned int >::const_iterator it = votes.begin(); it != votes.end(); ++it) {
+      candidates.push_back(std::make_pair(it->second, it->first));
+    }
+    unsigned int scored = std::min<size_t>(MAX_CANDIDATES, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + scored, candidates.end(), std::greater< std::pair<unsigned int, std::pair<unsigned int, long long> > >());
+
+    // the best alignment of each indexed fingerprint
+    std::map<unsigned int, FingerprintMatch> best;
+    for (unsigned int c = 0; c < scored; c++) {
+      unsigned int id = candidates[c].second.first;
+      long long offset = candidates[c].second.second;
+      const std::vector<unsigned int>& words = fingerprints.find(id)->second;
+
+      long long firstQuery = std::max(0LL, -offset);
+      long long lastQuery = std::min((long long)queryWords.size(), (long long)words.size() - offset);
+      if (lastQuery <= firstQuery) {
+        continue;
+      }
+      // a chance alignment of a few words proves nothing
+      size_t overlap = lastQuery - firstQuery;
+      if (overlap * 2 < std::min(queryWords.size(), words.size())) {
+        continue;
+      }
+      unsigned long long errors = 0;
+      for (long long q = firstQuery; q < lastQuery; q++) {
+        errors += ChromaFingerprint::hammingDistance(queryWords[q], words[q + offset]);
+      }
+      FingerprintMatch m;
+      m.id = id;
+      m.offset = offset;
+      m.overlap = overlap;
+      m.bitErrorRate = errors / (double)(overlap * FINGERPRINT_BITS);
+      if (m.bitErrorRate > maxBitErrorRate) {
+        continue;
+      }
+      std::map<unsigned int, FingerprintMatch>::iterator previous = best.find(id);
+      if (previous == best.end() || m.bitErrorRate < previous->second.bitErrorRate) {
+        best[id] = m;
+      }
+    }
+
+    std::vector<FingerprintMatch> matches;
+    for (std::map<unsigned int, FingerprintMatch>::const_iterator it = best.begin(); it != best.end(); ++it) {
+      matches.push_back(it->second);
+    }
+    std::sort(matches.begin(), matches.end(), closerMatch);
+    return matches;
+  }
+
+  size_t FingerprintIndex::getSize() const {
+    return fingerprints.size();
+  }
+
+}
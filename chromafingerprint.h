@@ -0,0 +1,77 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#ifndef CHROMAFINGERPRINT_H
+#define CHROMAFINGERPRINT_H
+
+#include "chromagram.h"
+#include "constants.h"
+#include <unordered_map>
+
+namespace KeyFinder {
+
+  // A binary fingerprint with one 32-bit word per hop after the first, for
+  // finding re-encodes and remasters of the same recording. Each word holds
+  //   bits  0-11: whether the difference between neighbouring pitch classes
+  //               rose since the previous hop,
+  //   bits 12-23: whether each pitch class is above the hop's median, and
+  //   bits 24-28: whether the difference between neighbouring octaves rose,
+  // all of which are unaffected by overall gain. Filled in by KeyFinder when
+  // a workspace points at one from its first call.
+  class ChromaFingerprint {
+  public:
+    ChromaFingerprint();
+    void append(const Chromagram& chromagram);
+    const std::vector<unsigned int>& getWords() const;
+    size_t size() const;
+    static unsigned int hammingDistance(unsigned int a, unsigned int b);
+  private:
+    std::vector<unsigned int> words;
+    std::vector<double> previousClasses;
+    std::vector<double> previousOctaves;
+  };
+
+  class FingerprintMatch {
+  public:
+    unsigned int id;
+    long long offset;    // hops into the indexed fingerprint where the query starts
+    size_t overlap;      // words compared
+    double bitErrorRate; // over the overlap
+  };
+
+  // Indexes fingerprints by their exact words. A query looks up each of its
+  // words and every word one bit away, votes for an alignment with each
+  // indexed fingerprint, and scores the best-supported alignments by the
+  // Hamming distance over their whole overlap.
+  class FingerprintIndex {
+  public:
+    FingerprintIndex();
+    void add(unsigned int id, const ChromaFingerprint& fingerprint);
+    std::vector<FingerprintMatch> match(const ChromaFingerprint& query, double maxBitErrorRate = 0.3) const;
+    size_t getSize() const;
+  private:
+    std::unordered_map< unsigned int, std::vector<unsigned int> > fingerprints;
+    std::unordered_map< unsigned int, std::vector< std::pair<unsigned int, size_t> > > postings;
+  };
+
+}
+
+#endif
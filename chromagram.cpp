@@ -23,9 +23,9 @@
 
 namespace KeyFinder {
 
-  Chromagram::Chromagram(unsigned int hops) : chromaData(hops, std::vector<double>(BANDS, 0.0)) { }
+  Chromagram::Chromagram(size_t hops) : chromaData(hops * BANDS, 0.0) { }
 
-  double Chromagram::getMagnitude(unsigned int hop, unsigned int band) const {
+  double Chromagram::getMagnitude(size_t hop, unsigned int band) const {
     if (hop >= getHops()) {
       std::ostringstream ss;
       ss << "Cannot get magnitude of out-of-bounds hop (" << hop << "/" << getHops() << ")";
@@ -36,10 +36,10 @@ namespace KeyFinder {
       ss << "Cannot get magnitude of out-of-bounds band (" << band << "/" << BANDS << ")";
       throw Exception(ss.str().c_str());
     }
-    return chromaData[hop][band];
+    return chromaData[hop * BANDS + band];
   }
 
-  void Chromagram::setMagnitude(unsigned int hop, unsigned int band, double value) {
+  void Chromagram::setMagnitude(size_t hop, unsigned int band, double value) {
     if (hop >= getHops()) {
       std::ostringstream ss;
       ss << "Cannot set magnitude of out-of-bounds hop (" << hop << "/" << getHops() << ")";
@@ -53,12 +53,12 @@ namespace KeyFinder {
     if (!std::isfinite(value)) {
       throw Exception("Cannot set magnitude to NaN");
     }
-    chromaData[hop][band] = value;
+    chromaData[hop * BANDS + band] = value;
   }
 
   std::vector<double> Chromagram::collapseToOneHop() const {
     std::vector<double> oneHop = std::vector<double>(BANDS, 0.0);
-    for (unsigned int h = 0; h < getHops(); h++) {
+    for (size_t h = 0; h < getHops(); h++) {
       for (unsigned int b = 0; b < BANDS; b++) {
         oneHop[b] += getMagnitude(h, b) / getHops();
       }
@@ -70,8 +70,17 @@ namespace KeyFinder {
     chromaData.insert(chromaData.end(), that.chromaData.begin(), that.chromaData.end());
   }
 
-  unsigned int Chromagram::getHops() const {
-    return chromaData.size();
+  size_t Chromagram::getHops() const {
+    return chromaData.size() / BANDS;
+  }
+
+  void Chromagram::swapData(std::vector<double>& data) {
+    if (data.size() % BANDS != 0) {
+      std::ostringstream ss;
+      ss << "Cannot swap in chroma data of " << data.size() << " values, not a whole number of hops";
+      throw Exception(ss.str().c_str());
+    }
+    chromaData.swap(data);
   }
 
 }
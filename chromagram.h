@@ -28,14 +28,15 @@ namespace KeyFinder {
 
   class Chromagram {
   public:
-    Chromagram(unsigned int hops = 0);
+    Chromagram(size_t hops = 0);
     void append(const Chromagram& that);
-    void setMagnitude(unsigned int hop, unsigned int band, double value);
-    double getMagnitude(unsigned int hop, unsigned int band) const;
-    unsigned int getHops() const;
+    void setMagnitude(size_t hop, unsigned int band, double value);
+    double getMagnitude(size_t hop, unsigned int band) const;
+    size_t getHops() const;
     std::vector<double> collapseToOneHop() const;
+    void swapData(std::vector<double>& data); // hop-major, BANDS per hop; for export without a copy
   private:
-    std::vector< std::vector<double> > chromaData;
+    std::vector<double> chromaData;
   };
 
 }
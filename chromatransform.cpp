@@ -23,31 +23,34 @@
 
 namespace KeyFinder {
 
-  ChromaTransform::ChromaTransform(unsigned int inFrameRate) {
+  ChromaTransform::ChromaTransform(unsigned int inFrameRate, unsigned int inFrameSize) {
 
     frameRate = inFrameRate;
+    frameSize = inFrameSize;
     if (frameRate < 1) {
       throw Exception("Frame rate must be > 0");
     }
 
+    if (frameSize < 2) {
+      throw Exception("Frame size must be > 1");
+    }
+
     if (getLastFrequency() > frameRate / 2.0) {
       throw Exception("Analysis frequencies over Nyquist");
     }
 
-    if (frameRate / (double)FFTFRAMESIZE > (getFrequencyOfBand(1) - getFrequencyOfBand(0))) {
+    if (frameRate / (double)frameSize > (getFrequencyOfBand(1) - getFrequencyOfBand(0))) {
       throw Exception("Insufficient low-end resolution");
     }
 
     chromaBandFftBinOffsets.resize(BANDS, 0);
     directSpectralKernel.resize(BANDS, std::vector<double>(0, 0.0));
 
-    double myQFactor = DIRECTSKSTRETCH * (pow(2,(1.0 / SEMITONES))-1);
-
     for (unsigned int i = 0; i < BANDS; i++) {
 
-      double centreOfWindow = getFrequencyOfBand(i) * FFTFRAMESIZE / inFrameRate;
-      double widthOfWindow = centreOfWindow * myQFactor;
-      double beginningOfWindow = centreOfWindow - (widthOfWindow / 2);
+      double beginningOfWindow;
+      double widthOfWindow;
+      placeWindow(i, frameRate, frameSize, beginningOfWindow, widthOfWindow);
       double endOfWindow = beginningOfWindow + widthOfWindow;
 
       double sumOfCoefficients = 0.0;
@@ -66,6 +69,24 @@ namespace KeyFinder {
     }
   }
 
+  void ChromaTransform::placeWindow(unsigned int band, unsigned int frameRate, unsigned int frameSize, double& beginning, double& width) {
+    double myQFactor = DIRECTSKSTRETCH * (pow(2,(1.0 / SEMITONES))-1);
+    double centreOfWindow = getFrequencyOfBand(band) * frameSize / frameRate;
+    width = centreOfWindow * myQFactor;
+    beginning = centreOfWindow - (width / 2);
+  }
+
+  size_t ChromaTransform::getKernelCoefficients(unsigned int frameRate, unsigned int frameSize) {
+    size_t coefficients = 0;
+    for (unsigned int i = 0; i < BANDS; i++) {
+      double beginningOfWindow;
+      double widthOfWindow;
+      placeWindow(i, frameRate, frameSize, beginningOfWindow, widthOfWindow);
+      coefficients += floor(beginningOfWindow + widthOfWindow) - ceil(beginningOfWindow) + 1;
+    }
+    return coefficients;
+  }
+
   double ChromaTransform::kernelWindow(double n, double N) const {
     // discretely sampled continuous function, but different to other window functions
     return 1.0 - cos((2 * PI * n) / N);
@@ -84,4 +105,37 @@ namespace KeyFinder {
     return chromaVector;
   }
 
+  std::vector<double> ChromaTransform::chromaVector(const std::vector<double>& magnitudes) const {
+    if (magnitudes.size() < frameSize / 2 + 1) {
+      std::ostringstream ss;
+      ss << "Spectrum has too few bins for frame size (" << magnitudes.size() << "/" << frameSize / 2 + 1 << ")";
+      throw Exception(ss.str().c_str());
+    }
+    std::vector<double> chromaVector(BANDS);
+    for (unsigned int i = 0; i < BANDS; i++) {
+      double sum = 0.0;
+      for (unsigned int j = 0; j < directSpectralKernel[i].size(); j++) {
+        sum += (magnitudes[chromaBandFftBinOffsets[i]+j] * directSpectralKernel[i][j]);
+      }
+      chromaVector[i] = sum;
+    }
+    return chromaVector;
+  }
+
+  unsigned int ChromaTransform::getFrameSize() const {
+    return frameSize;
+  }
+
+  unsigned int ChromaTransform::getFrameRate() const {
+    return frameRate;
+  }
+
+  size_t ChromaTransform::getKernelBytes() const {
+    size_t coefficients = 0;
+    for (unsigned int i = 0; i < BANDS; i++) {
+      coefficients += directSpectralKernel[i].size();
+    }
+    return coefficients * sizeof(double) + BANDS * (sizeof(std::vector<double>) + sizeof(unsigned int));
+  }
+
 }
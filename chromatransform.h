@@ -29,13 +29,20 @@ namespace KeyFinder {
 
   class ChromaTransform {
   public:
-    ChromaTransform(unsigned int frameRate);
+    ChromaTransform(unsigned int frameRate, unsigned int frameSize = FFTFRAMESIZE);
     std::vector<double> chromaVector(const FftAdapter* const fft) const;
+    std::vector<double> chromaVector(const std::vector<double>& magnitudes) const; // bins 0 to frameSize / 2
+    unsigned int getFrameSize() const;
+    unsigned int getFrameRate() const;
+    size_t getKernelBytes() const;
+    static size_t getKernelCoefficients(unsigned int frameRate, unsigned int frameSize = FFTFRAMESIZE); // without building the kernel
   protected:
     unsigned int frameRate;
+    unsigned int frameSize;
     std::vector< std::vector<double> > directSpectralKernel;
     std::vector<unsigned int> chromaBandFftBinOffsets;
     double kernelWindow(double n, double N) const;
+    static void placeWindow(unsigned int band, unsigned int frameRate, unsigned int frameSize, double& beginning, double& width);
   };
 
 }
@@ -24,29 +24,16 @@
 
 #include "constants.h"
 #include "chromatransform.h"
+#include "planregistry.h"
 
 namespace KeyFinder {
 
   class ChromaTransformFactory {
   public:
-    ChromaTransformFactory();
-    ~ChromaTransformFactory();
-    const ChromaTransform* getChromaTransform(unsigned int frameRate);
+    ChromaTransformFactory(PlanRegistry* registry = NULL); // NULL for the process-wide registry
+    std::shared_ptr<const ChromaTransform> getChromaTransform(unsigned int frameRate, unsigned int frameSize = FFTFRAMESIZE);
   private:
-    class ChromaTransformWrapper;
-    std::vector<ChromaTransformWrapper*> chromaTransforms;
-    std::mutex chromaTransformFactoryMutex;
-  };
-
-  class ChromaTransformFactory::ChromaTransformWrapper {
-  public:
-    ChromaTransformWrapper(unsigned int frameRate, const ChromaTransform* const transform);
-    ~ChromaTransformWrapper();
-    const ChromaTransform* getChromaTransform() const;
-    unsigned int getFrameRate() const;
-  private:
-    unsigned int frameRate;
-    const ChromaTransform* const chromaTransform;
+    PlanRegistry* registry;
   };
 
 }
@@ -0,0 +1,174 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+/*************************************************************************
+
+  Batch key detection of WAV files.
+
+  keyfinder-cli [--shard i/n] [--journal FILE] [--chroma] [--gate] [FILE...]
+  keyfinder-cli --merge JOURNAL...
+
+  Paths are read from the arguments, or one per line from stdin if there
+  are none. With --shard, only paths whose stable hash falls in shard i of
+  n are analysed, so n processes on any number of machines can split a
+  corpus with nothing shared but the file system. With --journal, results
+  are appended to FILE as they complete and paths already in it are
+  skipped, so an interrupted run can simply be restarted. --merge combines
+  the journals of all shards into one result set, and prints nothing if any
+  of them can't be opened.
+
+  Results are printed as tab-separated path and key, followed by the 72
+  chroma values if --chroma is given. With --gate, files that a quick look
+  at a few excerpts finds atonal, such as speech or noise, are reported as
+  silence without the full analysis, and with no chroma values.
+
+*************************************************************************/
+
+#include "wavreader.h"
+
+#include <cstring>
+#include <iostream>
+
+static const char* KEY_NAMES[] = {
+  "A", "Am", "Bb", "Bbm", "B", "Bm", "C", "Cm", "Db", "Dbm", "D", "Dm",
+  "Eb", "Ebm", "E", "Em", "F", "Fm", "Gb", "Gbm", "G", "Gm", "Ab", "Abm",
+  "silence"
+};
+
+static void print_result(const KeyFinder::BatchResult& result) {
+  std::cout << result.path << "\t" << KEY_NAMES[result.key];
+  for (unsigned int i = 0; i < result.chromaVector.size(); i++) {
+    std::cout << "\t" << result.chromaVector[i];
+  }
+  std::cout << std::endl;
+}
+
+static int usage() {
+  std::cerr << "usage: keyfinder-cli [--shard i/n] [--journal FILE] [--chroma] [--gate] [FILE...]" << std::endl;
+  std::cerr << "       keyfinder-cli --merge JOURNAL..." << std::endl;
+  return 2;
+}
+
+int main(int argc, char** argv) {
+
+  KeyFinder::ShardSpec shard;
+  std::string journalPath;
+  bool chroma = false;
+  bool gate = false;
+  bool merge = false;
+  std::vector<std::string> paths;
+
+  try {
+    for (int i = 1; i < argc; i++) {
+      if (strcmp(argv[i], "--shard") == 0 && i + 1 < argc) {
+        shard = KeyFinder::ShardSpec(argv[++i]);
+      } else if (strcmp(argv[i], "--journal") == 0 && i + 1 < argc) {
+        journalPath = argv[++i];
+      } else if (strcmp(argv[i], "--chroma") == 0) {
+        chroma = true;
+      } else if (strcmp(argv[i], "--gate") == 0) {
+        gate = true;
+      } else if (strcmp(argv[i], "--merge") == 0) {
+        merge = true;
+      } else if (strncmp(argv[i], "--", 2) == 0) {
+        return usage();
+      } else {
+        paths.push_back(argv[i]);
+      }
+    }
+  } catch (const KeyFinder::Exception& e) {
+    std::cerr << e.what() << std::endl;
+    return usage();
+  }
+
+  if (merge) {
+    if (paths.empty()) {
+      return usage();
+    }
+    std::vector<KeyFinder::BatchResult> merged;
+    try {
+      merged = KeyFinder::BatchJournal::merge(paths);
+    } catch (const std::exception& e) {
+      std::cerr << e.what() << std::endl;
+      return 1;
+    }
+    for (unsigned int i = 0; i < merged.size(); i++) {
+      print_result(merged[i]);
+    }
+    return 0;
+  }
+
+  if (paths.empty()) {
+    std::string line;
+    while (std::getline(std::cin, line)) {
+      if (!line.empty()) {
+        paths.push_back(line);
+      }
+    }
+  }
+
+  KeyFinder::BatchJournal* journal = NULL;
+  if (!journalPath.empty()) {
+    try {
+      journal = new KeyFinder::BatchJournal(journalPath);
+    } catch (const std::exception& e) {
+      std::cerr << e.what() << std::endl;
+      return 1;
+    }
+  }
+
+  KeyFinder::KeyFinder k;
+  KeyFinder::TonalityGate tonalityGate;
+  int failures = 0;
+
+  for (unsigned int i = 0; i < paths.size(); i++) {
+    if (!shard.includes(paths[i]) || (journal != NULL && journal->contains(paths[i]))) {
+      continue;
+    }
+    try {
+      KeyFinder::AudioData audio;
+      read_wav_file(paths[i], audio);
+      KeyFinder::BatchResult result;
+      result.path = paths[i];
+      if (gate && tonalityGate.assess(audio).atonal) {
+        result.key = KeyFinder::SILENCE;
+      } else {
+        KeyFinder::Workspace w;
+        k.progressiveChromagram(audio, w);
+        k.finalChromagram(w);
+        result.key = k.keyOfChromagram(w);
+        if (chroma) {
+          result.chromaVector = w.chromagram->collapseToOneHop();
+        }
+      }
+      if (journal != NULL) {
+        journal->append(result);
+      }
+      print_result(result);
+    } catch (const std::exception& e) {
+      std::cerr << e.what() << std::endl;
+      failures++;
+    }
+  }
+
+  delete journal;
+  return failures > 0 ? 1 : 0;
+}
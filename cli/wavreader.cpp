@@ -0,0 +1,133 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#include "wavreader.h"
+
+#include <cstring>
+#include <fstream>
+
+static unsigned int little_endian(const unsigned char* bytes, unsigned int count) {
+  unsigned int value = 0;
+  for (unsigned int i = 0; i < count; i++) {
+    value |= (unsigned int)bytes[i] << (8 * i);
+  }
+  return value;
+}
+
+static void fail(const std::string& path, const char* reason) {
+  std::string message = path + ": " + reason;
+  throw KeyFinder::Exception(message.c_str());
+}
+
+void read_wav_file(const std::string& path, KeyFinder::AudioData& audio) {
+
+  std::ifstream file(path.c_str(), std::ios::binary);
+  if (!file) {
+    fail(path, "cannot open");
+  }
+
+  unsigned char riff[12];
+  if (!file.read((char*)riff, 12) || memcmp(riff, "RIFF", 4) != 0 || memcmp(riff + 8, "WAVE", 4) != 0) {
+    fail(path, "not a RIFF WAVE file");
+  }
+
+  unsigned int format = 0;
+  unsigned int channels = 0;
+  unsigned int frameRate = 0;
+  unsigned int bitsPerSample = 0;
+
+  unsigned char chunk[8];
+  while (file.read((char*)chunk, 8)) {
+    unsigned int chunkSize = little_endian(chunk + 4, 4);
+
+    if (memcmp(chunk, "fmt ", 4) == 0) {
+      std::vector<unsigned char> fmt(chunkSize + (chunkSize % 2));
+      if (chunkSize < 16 || !file.read((char*)&fmt[0], fmt.size())) {
+        fail(path, "truncated format chunk");
+      }
+      format = little_endian(&fmt[0], 2);
+      channels = little_endian(&fmt[2], 2);
+      frameRate = little_endian(&fmt[4], 4);
+      bitsPerSample = little_endian(&fmt[14], 2);
+      if (format == 0xFFFE && chunkSize >= 26) {
+        format = little_endian(&fmt[24], 2); // extensible sub-format
+      }
+      continue;
+    }
+
+    if (memcmp(chunk, "data", 4) != 0) {
+      file.seekg(chunkSize + (chunkSize % 2), std::ios::cur);
+      continue;
+    }
+
+    if (channels == 0 || frameRate == 0) {
+      fail(path, "data before format chunk");
+    }
+    bool pcm = (format == 1 && bitsPerSample >= 8 && bitsPerSample <= 32 && bitsPerSample % 8 == 0);
+    bool ieee = (format == 3 && (bitsPerSample == 32 || bitsPerSample == 64));
+    if (!pcm && !ieee) {
+      fail(path, "unsupported sample format");
+    }
+
+    unsigned int bytesPerSample = bitsPerSample / 8;
+    unsigned int sampleCount = chunkSize / bytesPerSample;
+    sampleCount -= sampleCount % channels;
+
+    audio.setChannels(channels);
+    audio.setFrameRate(frameRate);
+    audio.addToSampleCount(sampleCount);
+    audio.resetIterators();
+
+    std::vector<unsigned char> buffer(bytesPerSample * 4096);
+    unsigned int remaining = sampleCount;
+    while (remaining > 0) {
+      unsigned int batch = std::min<unsigned int>(remaining, 4096);
+      if (!file.read((char*)&buffer[0], batch * bytesPerSample)) {
+        fail(path, "truncated data chunk");
+      }
+      for (unsigned int i = 0; i < batch; i++) {
+        const unsigned char* bytes = &buffer[i * bytesPerSample];
+        double sample;
+        if (ieee && bitsPerSample == 32) {
+          float f;
+          memcpy(&f, bytes, 4);
+          sample = f;
+        } else if (ieee) {
+          memcpy(&sample, bytes, 8);
+        } else if (bitsPerSample == 8) {
+          sample = (bytes[0] - 128) / 128.0; // 8-bit is unsigned
+        } else {
+          // sign-extend from the top byte
+          unsigned int raw = little_endian(bytes, bytesPerSample) << (32 - bitsPerSample);
+          int value;
+          memcpy(&value, &raw, 4);
+          sample = value / 2147483648.0;
+        }
+        audio.setSampleAtWriteIterator(std::isfinite(sample) ? sample : 0.0);
+        audio.advanceWriteIterator();
+      }
+      remaining -= batch;
+    }
+    return;
+  }
+
+  fail(path, "no data chunk");
+}
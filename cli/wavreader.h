@@ -0,0 +1,33 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#ifndef WAVREADER_H
+#define WAVREADER_H
+
+#include <string>
+#include "keyfinder/keyfinder.h"
+
+// Reads uncompressed RIFF WAVE files: 8, 16, 24 and 32-bit integer PCM and
+// 32 and 64-bit float, including WAVE_FORMAT_EXTENSIBLE. Throws
+// KeyFinder::Exception on anything else.
+void read_wav_file(const std::string& path, KeyFinder::AudioData& audio);
+
+#endif // WAVREADER_H
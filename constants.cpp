@@ -111,6 +111,11 @@ namespace KeyFinder {
     return FREQUENCIES[BANDS - 1];
   }
 
+  unsigned int getDownsampleFactor(unsigned int frameRate) {
+    double dsCutoff = getLastFrequency() * 1.10;
+    return (int) floor(frameRate / 2 / dsCutoff);
+  }
+
   static double MAJOR_PROFILE[SEMITONES] = {
     7.23900502618145225142,
     3.50351166725158691406,
@@ -25,6 +25,7 @@
 #include <cmath>
 #include <vector>
 #include <deque>
+#include <algorithm>
 #include <mutex>
 #include "exception.h"
 
@@ -55,6 +56,12 @@
 #undef  DIRECTSKSTRETCH
 #define DIRECTSKSTRETCH 0.8
 
+#undef  LPFORDER
+#define LPFORDER 160
+
+#undef  LPFFFTFRAMESIZE
+#define LPFFFTFRAMESIZE 2048
+
 namespace KeyFinder {
 
   enum key_t {
@@ -95,8 +102,15 @@ namespace KeyFinder {
     SCALE_MINOR
   };
 
+  enum channel_analysis_t {
+    CHANNELS_SEPARATE,
+    CHANNELS_MID_SIDE
+  };
+
   double getFrequencyOfBand(unsigned int band);
   double getLastFrequency();
+  // how far the analysis decimates audio at this rate before the spectrum
+  unsigned int getDownsampleFactor(unsigned int frameRate);
 
   const std::vector<double>& toneProfileMajor();
   const std::vector<double>& toneProfileMinor();
@@ -0,0 +1,109 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#include "costestimator.h"
+
+namespace KeyFinder {
+
+  // Before any runs have been observed, assume somewhere between 10 GFLOP/s
+  // and 100 MFLOP/s; observed runs then narrow this to the host's real rate.
+  static const double UNCALIBRATED_MIN_SECONDS_PER_FLOP = 1.0e-10;
+  static const double UNCALIBRATED_MAX_SECONDS_PER_FLOP = 1.0e-8;
+  static const double CALIBRATION_WEIGHT = 0.2;
+
+  CostEstimate::CostEstimate() : hops(0), flops(0.0), peakMemoryBytes(0.0), minSeconds(0.0), maxSeconds(0.0) { }
+
+  CostEstimator::CostEstimator() : meanSecondsPerFlop(0.0), deviationSecondsPerFlop(0.0), observations(0) { }
+
+  CostEstimate CostEstimator::estimate(size_t frames, unsigned int channels, unsigned int frameRate, unsigned int downsampleFactor) const {
+
+    if (channels < 1) {
+      throw Exception("Channels must be > 0");
+    }
+    if (downsampleFactor < 1) {
+      throw Exception("Downsample factor must be > 0");
+    }
+
+    CostEstimate e;
+    double samples = (double)frames * channels;
+    double preprocessedSamples = ceil(frames / (double)downsampleFactor);
+    e.hops = ceil(preprocessedSamples / HOPSIZE);
+
+    // mono reduction, then the LPF: a division per input sample and a
+    // multiply-accumulate per tap for each sample kept by the decimator.
+    if (channels > 1) {
+      e.flops += samples;
+    }
+    e.flops += frames;
+    e.flops += preprocessedSamples * (LPFORDER + 1) * 2.0;
+
+    // per hop: windowing, a real FFT, and the chroma kernel, each
+    // coefficient of which costs a magnitude and a multiply-accumulate.
+    double fftFlops = 2.5 * FFTFRAMESIZE * log2((double)FFTFRAMESIZE);
+    double kernelFlops = ChromaTransform::getKernelCoefficients(frameRate / downsampleFactor) * 7.0;
+    e.flops += e.hops * (FFTFRAMESIZE + fftFlops + kernelFlops);
+
+    // collapsing the chromagram and classifying against 25 profiles
+    e.flops += e.hops * BANDS * 2.0;
+    e.flops += (KEYS + 1) * BANDS * 6.0;
+
+    // the by-value copy of the input and the preprocessed buffer coexist,
+    // alongside the FFT buffers, temporal window and chromagram rows.
+    e.peakMemoryBytes += samples * sizeof(double);
+    e.peakMemoryBytes += (preprocessedSamples + FFTFRAMESIZE) * sizeof(double);
+    e.peakMemoryBytes += FFTFRAMESIZE * (sizeof(double) * 4);
+    e.peakMemoryBytes += (LPFORDER + 1) * sizeof(double) * 2;
+    e.peakMemoryBytes += e.hops * (BANDS * sizeof(double) + sizeof(std::vector<double>)) * 2;
+
+    std::lock_guard<std::mutex> lock(costEstimatorMutex);
+    if (observations == 0) {
+      e.minSeconds = e.flops * UNCALIBRATED_MIN_SECONDS_PER_FLOP;
+      e.maxSeconds = e.flops * UNCALIBRATED_MAX_SECONDS_PER_FLOP;
+    } else {
+      e.minSeconds = e.flops * std::max(0.0, meanSecondsPerFlop - 2.0 * deviationSecondsPerFlop);
+      e.maxSeconds = e.flops * (meanSecondsPerFlop + 2.0 * deviationSecondsPerFlop);
+    }
+    return e;
+  }
+
+  void CostEstimator::observe(const CostEstimate& estimate, double seconds) {
+    if (estimate.flops <= 0.0 || !std::isfinite(seconds) || seconds < 0.0) {
+      return;
+    }
+    double secondsPerFlop = seconds / estimate.flops;
+    std::lock_guard<std::mutex> lock(costEstimatorMutex);
+    if (observations == 0) {
+      meanSecondsPerFlop = secondsPerFlop;
+      deviationSecondsPerFlop = secondsPerFlop / 2.0;
+    } else {
+      double deviation = fabs(secondsPerFlop - meanSecondsPerFlop);
+      meanSecondsPerFlop += CALIBRATION_WEIGHT * (secondsPerFlop - meanSecondsPerFlop);
+      deviationSecondsPerFlop += CALIBRATION_WEIGHT * (deviation - deviationSecondsPerFlop);
+    }
+    observations++;
+  }
+
+  unsigned int CostEstimator::getObservations() const {
+    std::lock_guard<std::mutex> lock(costEstimatorMutex);
+    return observations;
+  }
+
+}
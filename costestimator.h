@@ -0,0 +1,55 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#ifndef COSTESTIMATOR_H
+#define COSTESTIMATOR_H
+
+#include "constants.h"
+#include "chromatransform.h"
+
+namespace KeyFinder {
+
+  class CostEstimate {
+  public:
+    CostEstimate();
+    size_t hops;
+    double flops;
+    double peakMemoryBytes;
+    double minSeconds;
+    double maxSeconds;
+  };
+
+  class CostEstimator {
+  public:
+    CostEstimator();
+    CostEstimate estimate(size_t frames, unsigned int channels, unsigned int frameRate, unsigned int downsampleFactor) const;
+    void observe(const CostEstimate& estimate, double seconds);
+    unsigned int getObservations() const;
+  private:
+    double meanSecondsPerFlop;
+    double deviationSecondsPerFlop;
+    unsigned int observations;
+    mutable std::mutex costEstimatorMutex;
+  };
+
+}
+
+#endif
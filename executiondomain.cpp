@@ -0,0 +1,223 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#include "executiondomain.h"
+
+#include <chrono>
+#include <exception>
+#ifdef __linux__
+#include <cerrno>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace KeyFinder {
+
+  static thread_local const ExecutionDomain* currentDomain = NULL;
+
+  class ExecutionDomain::Task {
+  public:
+    std::function<void()> job;
+    std::promise<void> done;
+    std::chrono::steady_clock::time_point queued;
+  };
+
+  ExecutionDomainMetrics::ExecutionDomainMetrics() : submitted(0), completed(0), failed(0), bindFailures(0) { }
+
+  void ExecutionDomainMetrics::write(std::ostream& report, const std::string& name) const {
+    report << name << " submitted " << submitted << " completed " << completed;
+    report << " failed " << failed << " bindFailures " << bindFailures << "\n";
+    report << name << " queueWait count " << queueWait.getCount() << " mean " << queueWait.getMean();
+    report << " p99 " << queueWait.percentile(99.0) << " max " << queueWait.getMax() << "\n";
+    report << name << " run count " << run.getCount() << " mean " << run.getMean();
+    report << " p99 " << run.percentile(99.0) << " max " << run.getMax() << "\n";
+  }
+
+  ExecutionDomain::ExecutionDomain(const std::string& inName, unsigned int threads, const std::vector<unsigned int>& inCpus, domain_priority_t inPriority) :
+    name(inName), cpus(inCpus), priority(inPriority), running(0), stopping(false) {
+    if (threads == 0) {
+      throw Exception("An execution domain needs at least one thread");
+    }
+    for (unsigned int i = 0; i < threads; i++) {
+      workers.push_back(new std::thread(&ExecutionDomain::work, this));
+    }
+  }
+
+  ExecutionDomain::~ExecutionDomain() {
+    {
+      std::lock_guard<std::mutex> lock(executionDomainMutex);
+      stopping = true;
+    }
+    queueChanged.notify_all();
+    for (unsigned int i = 0; i < workers.size(); i++) {
+      workers[i]->join();
+      delete workers[i];
+    }
+  }
+
+  const std::string& ExecutionDomain::getName() const {
+    return name;
+  }
+
+  unsigned int ExecutionDomain::getThreadCount() const {
+    return workers.size();
+  }
+
+  const std::vector<unsigned int>& ExecutionDomain::getCpus() const {
+    return cpus;
+  }
+
+  domain_priority_t ExecutionDomain::getPriority() const {
+    return priority;
+  }
+
+  const ExecutionDomainMetrics& ExecutionDomain::getMetrics() const {
+    return metrics;
+  }
+
+  bool ExecutionDomain::isCurrent() const {
+    return currentDomain == this;
+  }
+
+  std::future<void> ExecutionDomain::submit(const std::function<void()>& job) {
+    Task* task = new Task();
+    task->job = job;
+    task->queued = std::chrono::steady_clock::now();
+    std::future<void> result = task->done.get_future();
+    {
+      std::lock_guard<std::mutex> lock(executionDomainMutex);
+      queue.push_back(task);
+    }
+    metrics.submitted++;
+    queueChanged.notify_one();
+    return result;
+  }
+
+  void ExecutionDomain::wait() {
+    std::unique_lock<std::mutex> lock(executionDomainMutex);
+    while (!queue.empty() || running > 0) {
+      queueChanged.wait(lock);
+    }
+  }
+
+  bool ExecutionDomain::bindCurrentThread() {
+    bool bound = true;
+#ifdef __linux__
+    if (!cpus.empty()) {
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      for (unsigned int i = 0; i < cpus.size(); i++) {
+        if (cpus[i] < CPU_SETSIZE) {
+          CPU_SET(cpus[i], &set);
+        }
+      }
+      if (CPU_COUNT(&set) == 0 || pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+        bound = false;
+      }
+    }
+    if (priority == PRIORITY_BACKGROUND) {
+      // nice levels are per thread on Linux
+      if (setpriority(PRIO_PROCESS, syscall(SYS_gettid), 19) != 0) {
+        bound = false;
+      }
+    } else if (priority == PRIORITY_REALTIME) {
+      sched_param parameters;
+      parameters.sched_priority = sched_get_priority_min(SCHED_FIFO);
+      if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &parameters) != 0) {
+        bound = false;
+      }
+    }
+#else
+    bound = cpus.empty() && priority == PRIORITY_NORMAL;
+#endif
+    if (!bound) {
+      metrics.bindFailures++;
+    }
+    return bound;
+  }
+
+  bool ExecutionDomain::unbindCurrentThread() {
+    bool unbound = true;
+#ifdef __linux__
+    // with the pid, these refer to the main thread rather than to this one
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(getpid(), sizeof(set), &set) != 0 || pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+      unbound = false;
+    }
+    sched_param parameters;
+    parameters.sched_priority = 0;
+    if (pthread_setschedparam(pthread_self(), SCHED_OTHER, &parameters) != 0) {
+      unbound = false;
+    }
+    errno = 0;
+    int nice = getpriority(PRIO_PROCESS, getpid());
+    if (errno != 0 || setpriority(PRIO_PROCESS, syscall(SYS_gettid), nice) != 0) {
+      unbound = false;
+    }
+#endif
+    return unbound;
+  }
+
+  void ExecutionDomain::work() {
+    currentDomain = this;
+    bindCurrentThread();
+    std::unique_lock<std::mutex> lock(executionDomainMutex);
+    while (true) {
+      while (queue.empty() && !stopping) {
+        queueChanged.wait(lock);
+      }
+      if (queue.empty()) {
+        return;
+      }
+      Task* task = queue.front();
+      queue.pop_front();
+      running++;
+      lock.unlock();
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      metrics.queueWait.record(std::chrono::duration_cast<std::chrono::nanoseconds>(start - task->queued).count());
+      std::exception_ptr failure;
+      try {
+        task->job();
+      } catch (...) {
+        failure = std::current_exception();
+      }
+      // counted before the promise is kept, so a caller that has waited on
+      // the future sees its task in the metrics
+      metrics.run.record(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+      if (failure) {
+        metrics.failed++;
+        task->done.set_exception(failure);
+      } else {
+        metrics.completed++;
+        task->done.set_value();
+      }
+      delete task;
+      lock.lock();
+      running--;
+      queueChanged.notify_all();
+    }
+  }
+
+}
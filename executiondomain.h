@@ -0,0 +1,100 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#ifndef EXECUTIONDOMAIN_H
+#define EXECUTIONDOMAIN_H
+
+#include "constants.h"
+#include "latencyhistogram.h"
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <string>
+#include <thread>
+
+namespace KeyFinder {
+
+  enum domain_priority_t {
+    PRIORITY_NORMAL,
+    PRIORITY_BACKGROUND, // lowest nice level, for batch analysis
+    PRIORITY_REALTIME    // SCHED_FIFO; needs CAP_SYS_NICE or an rtprio limit
+  };
+
+  // Task counts and latencies of one domain, in nanoseconds. Binding failures
+  // count the threads whose affinity or priority the OS refused; they carry
+  // on unpinned rather than failing the work.
+  class ExecutionDomainMetrics {
+  public:
+    ExecutionDomainMetrics();
+    std::atomic<unsigned long long> submitted;
+    std::atomic<unsigned long long> completed;
+    std::atomic<unsigned long long> failed;
+    std::atomic<unsigned long long> bindFailures;
+    LatencyHistogram queueWait;
+    LatencyHistogram run;
+    void write(std::ostream& report, const std::string& name) const;
+  private:
+    ExecutionDomainMetrics(const ExecutionDomainMetrics&);
+    ExecutionDomainMetrics& operator=(const ExecutionDomainMetrics&);
+  };
+
+  // A named pool of worker threads pinned to a set of CPUs at a given
+  // priority, so that batch analysis can be kept off the cores reserved for a
+  // live stream. Threads the library doesn't own, such as an audio callback
+  // that calls progressiveChromagram, join a domain with bindCurrentThread,
+  // and leave it with unbindCurrentThread, which restores the affinity,
+  // scheduling policy and nice level of the process's main thread.
+  // An empty CPU set leaves the affinity alone; affinity is only applied on
+  // Linux. Tasks still queued on destruction are run before the workers exit.
+  class ExecutionDomain {
+  public:
+    ExecutionDomain(const std::string& name, unsigned int threads, const std::vector<unsigned int>& cpus = std::vector<unsigned int>(), domain_priority_t priority = PRIORITY_NORMAL);
+    ~ExecutionDomain();
+    const std::string& getName() const;
+    unsigned int getThreadCount() const;
+    const std::vector<unsigned int>& getCpus() const;
+    domain_priority_t getPriority() const;
+    std::future<void> submit(const std::function<void()>& task);
+    void wait();
+    bool bindCurrentThread();
+    static bool unbindCurrentThread(); // false if the OS refuses, e.g. raising nice without CAP_SYS_NICE
+    bool isCurrent() const; // true on this domain's own workers
+    const ExecutionDomainMetrics& getMetrics() const;
+  private:
+    ExecutionDomain(const ExecutionDomain&);
+    ExecutionDomain& operator=(const ExecutionDomain&);
+    class Task;
+    void work();
+    std::string name;
+    std::vector<unsigned int> cpus;
+    domain_priority_t priority;
+    std::vector<std::thread*> workers;
+    std::deque<Task*> queue;
+    unsigned int running;
+    bool stopping;
+    ExecutionDomainMetrics metrics;
+    std::mutex executionDomainMutex;
+    std::condition_variable queueChanged;
+  };
+
+}
+
+#endif
@@ -29,22 +29,43 @@
 namespace KeyFinder {
 
   std::mutex fftwPlanMutex;
+  static bool fftwMeasure = false;
+  static unsigned long long fftwPlans = 0;
+
+  // Plans from wisdom where there is any, imported or measured earlier in
+  // this process; otherwise measured if asked, or estimated. Called with
+  // fftwPlanMutex held.
+  static unsigned int planningFlags() {
+    return fftwMeasure ? FFTW_MEASURE : FFTW_ESTIMATE;
+  }
+
+  static const char* planningName() {
+    return fftwMeasure ? "measured" : "estimated";
+  }
 
   class FftAdapterPrivate {
   public:
     double* inputReal;
     fftw_complex* outputComplex;
     fftw_plan plan;
+    const char* planning;
   };
 
   FftAdapter::FftAdapter(unsigned int inFrameSize) : priv(new FftAdapterPrivate) {
     frameSize = inFrameSize;
     priv->inputReal = (double*)fftw_malloc(sizeof(double) * frameSize);
     priv->outputComplex = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * frameSize);
-    memset(priv->outputComplex, 0, sizeof(fftw_complex) * frameSize);
     fftwPlanMutex.lock();
-    priv->plan = fftw_plan_dft_r2c_1d(frameSize, priv->inputReal, priv->outputComplex, FFTW_ESTIMATE);
+    priv->plan = fftw_plan_dft_r2c_1d(frameSize, priv->inputReal, priv->outputComplex, FFTW_MEASURE | FFTW_WISDOM_ONLY);
+    priv->planning = "wisdom";
+    if (priv->plan == NULL) {
+      priv->plan = fftw_plan_dft_r2c_1d(frameSize, priv->inputReal, priv->outputComplex, planningFlags());
+      priv->planning = planningName();
+    }
+    fftwPlans++;
     fftwPlanMutex.unlock();
+    // after planning, since measuring overwrites the arrays
+    memset(priv->outputComplex, 0, sizeof(fftw_complex) * frameSize);
   }
 
   FftAdapter::~FftAdapter() {
@@ -58,6 +79,10 @@ namespace KeyFinder {
     return frameSize;
   }
 
+  const char* FftAdapter::getPlanning() const {
+    return priv->planning;
+  }
+
   void FftAdapter::setInput(unsigned int i, double real) {
     if (i >= frameSize) {
       std::ostringstream ss;
@@ -108,6 +133,7 @@ namespace KeyFinder {
     fftw_complex* inputComplex;
     double* outputReal;
     fftw_plan plan;
+    const char* planning;
   };
 
   InverseFftAdapter::InverseFftAdapter(unsigned int inFrameSize) : priv(new InverseFftAdapterPrivate) {
@@ -115,7 +141,13 @@ namespace KeyFinder {
     priv->inputComplex = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * frameSize);
     priv->outputReal = (double*)fftw_malloc(sizeof(double) * frameSize);
     fftwPlanMutex.lock();
-    priv->plan = fftw_plan_dft_c2r_1d(frameSize, priv->inputComplex, priv->outputReal, FFTW_ESTIMATE);
+    priv->plan = fftw_plan_dft_c2r_1d(frameSize, priv->inputComplex, priv->outputReal, FFTW_MEASURE | FFTW_WISDOM_ONLY);
+    priv->planning = "wisdom";
+    if (priv->plan == NULL) {
+      priv->plan = fftw_plan_dft_c2r_1d(frameSize, priv->inputComplex, priv->outputReal, planningFlags());
+      priv->planning = planningName();
+    }
+    fftwPlans++;
     fftwPlanMutex.unlock();
   }
 
@@ -130,6 +162,10 @@ namespace KeyFinder {
     return frameSize;
   }
 
+  const char* InverseFftAdapter::getPlanning() const {
+    return priv->planning;
+  }
+
   void InverseFftAdapter::setInput(unsigned int i, double real, double imag) {
     if (i >= frameSize) {
       std::ostringstream ss;
@@ -157,4 +193,24 @@ namespace KeyFinder {
     fftw_execute(priv->plan);
   }
 
+  bool importFftWisdom(const char* filename) {
+    std::lock_guard<std::mutex> lock(fftwPlanMutex);
+    return fftw_import_wisdom_from_filename(filename) != 0;
+  }
+
+  void setFftPlanMeasuring(bool measure) {
+    std::lock_guard<std::mutex> lock(fftwPlanMutex);
+    fftwMeasure = measure;
+  }
+
+  unsigned long long getFftPlanCount() {
+    std::lock_guard<std::mutex> lock(fftwPlanMutex);
+    return fftwPlans;
+  }
+
+  bool exportFftWisdom(const char* filename) {
+    std::lock_guard<std::mutex> lock(fftwPlanMutex);
+    return fftw_export_wisdom_to_filename(filename) != 0;
+  }
+
 }
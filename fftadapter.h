@@ -34,6 +34,7 @@ namespace KeyFinder {
     FftAdapter(unsigned int frameSize);
     ~FftAdapter();
     unsigned int getFrameSize() const;
+    const char* getPlanning() const; // "wisdom", "measured" or "estimated"
     void setInput(unsigned int sample, double real);
     void execute();
     double getOutputReal(unsigned int bin) const;
@@ -49,6 +50,7 @@ namespace KeyFinder {
     InverseFftAdapter(unsigned int frameSize);
     ~InverseFftAdapter();
     unsigned int getFrameSize() const;
+    const char* getPlanning() const;
     void setInput(unsigned int sample, double real, double imaginary);
     void execute();
     double getOutput(unsigned int bin) const;
@@ -57,6 +59,18 @@ namespace KeyFinder {
     InverseFftAdapterPrivate* priv;
   };
 
+  // FFTW's accumulated plans, so that a new process can skip planning.
+  // Adapters use wisdom for their size wherever there is some, and otherwise
+  // estimate a plan. Only measured plans add to the wisdom, so the process
+  // that exports it should turn measuring on before building its adapters,
+  // e.g. with KeyFinder::prewarm.
+  bool importFftWisdom(const char* filename);
+  bool exportFftWisdom(const char* filename);
+  void setFftPlanMeasuring(bool measure);
+
+  // plans made by adapters in this process, forward and inverse
+  unsigned long long getFftPlanCount();
+
 }
 
 #endif
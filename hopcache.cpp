@@ -0,0 +1,169 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#include "hopcache.h"
+#include <cstring>
+
+namespace KeyFinder {
+
+  HopCache::HopCache(unsigned int inCapacity) : capacity(inCapacity), rows(), index(), hits(0), misses(0), evictions(0) {
+    if (capacity == 0) throw Exception("Hop cache capacity must be > 0");
+  }
+
+  bool HopCache::lookup(unsigned long long hash, unsigned long long check, std::vector<double>& chroma) {
+    std::lock_guard<std::mutex> lock(hopCacheMutex);
+    std::unordered_map< unsigned long long, std::list<Row>::iterator >::const_iterator it = index.find(hash);
+    if (it == index.end() || it->second->check != check) {
+      misses++;
+      return false;
+    }
+    hits++;
+    rows.splice(rows.begin(), rows, it->second);
+    chroma = it->second->chroma;
+    return true;
+  }
+
+  void HopCache::store(unsigned long long hash, unsigned long long check, const std::vector<double>& chroma) {
+    std::lock_guard<std::mutex> lock(hopCacheMutex);
+    std::unordered_map< unsigned long long, std::list<Row>::iterator >::iterator it = index.find(hash);
+    if (it != index.end()) {
+      // same key, and either the same input or a colliding one: keep the latest
+      it->second->check = check;
+      it->second->chroma = chroma;
+      rows.splice(rows.begin(), rows, it->second);
+      return;
+    }
+    Row row;
+    row.hash = hash;
+    row.check = check;
+    row.chroma = chroma;
+    rows.push_front(row);
+    index[hash] = rows.begin();
+    evict();
+  }
+
+  void HopCache::evict() {
+    while (rows.size() > capacity) {
+      index.erase(rows.back().hash);
+      rows.pop_back();
+      evictions++;
+    }
+  }
+
+  void HopCache::clear() {
+    std::lock_guard<std::mutex> lock(hopCacheMutex);
+    rows.clear();
+    index.clear();
+    hits = 0;
+    misses = 0;
+    evictions = 0;
+  }
+
+  void HopCache::setCapacity(unsigned int inCapacity) {
+    if (inCapacity == 0) throw Exception("Hop cache capacity must be > 0");
+    std::lock_guard<std::mutex> lock(hopCacheMutex);
+    capacity = inCapacity;
+    evict();
+  }
+
+  unsigned int HopCache::getCapacity() const {
+    std::lock_guard<std::mutex> lock(hopCacheMutex);
+    return capacity;
+  }
+
+  unsigned int HopCache::getSize() const {
+    std::lock_guard<std::mutex> lock(hopCacheMutex);
+    return rows.size();
+  }
+
+  unsigned long long HopCache::getHits() const {
+    std::lock_guard<std::mutex> lock(hopCacheMutex);
+    return hits;
+  }
+
+  unsigned long long HopCache::getMisses() const {
+    std::lock_guard<std::mutex> lock(hopCacheMutex);
+    return misses;
+  }
+
+  unsigned long long HopCache::getEvictions() const {
+    std::lock_guard<std::mutex> lock(hopCacheMutex);
+    return evictions;
+  }
+
+  // FNV-1a over whole 64-bit words rather than bytes, with a final mix so
+  // that every bit of every sample reaches the top of the hash.
+  static const unsigned long long FNV_OFFSET = 14695981039346656037ULL;
+  static const unsigned long long FNV_PRIME = 1099511628211ULL;
+
+  static unsigned long long finalise(unsigned long long hash) {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return hash;
+  }
+
+  unsigned long long HopCache::hashOfBlock(const double* samples, unsigned int count) {
+    unsigned long long hash = FNV_OFFSET;
+    for (unsigned int i = 0; i < count; i++) {
+      unsigned long long bits;
+      memcpy(&bits, &samples[i], sizeof(bits));
+      hash ^= bits;
+      hash *= FNV_PRIME;
+    }
+    return finalise(hash);
+  }
+
+  // The key hash above is cheap but weak: multiplying never carries high
+  // bits down, so sign flips in pairs cancel out, e.g. a block and its
+  // polarity-inverted copy hash alike. The check runs the splitmix64
+  // finaliser after every sample instead, from a seed of its own.
+  static const unsigned long long CHECK_SEED = 0x9e3779b97f4a7c15ULL;
+
+  static unsigned long long avalanche(unsigned long long hash) {
+    hash ^= hash >> 30;
+    hash *= 0xbf58476d1ce4e5b9ULL;
+    hash ^= hash >> 27;
+    hash *= 0x94d049bb133111ebULL;
+    hash ^= hash >> 31;
+    return hash;
+  }
+
+  unsigned long long HopCache::checkOfBlock(const double* samples, unsigned int count) {
+    unsigned long long hash = CHECK_SEED;
+    for (unsigned int i = 0; i < count; i++) {
+      unsigned long long bits;
+      memcpy(&bits, &samples[i], sizeof(bits));
+      hash = avalanche(hash + bits);
+    }
+    return hash;
+  }
+
+  unsigned long long HopCache::combine(unsigned long long seed, const std::vector<unsigned long long>& blockHashes, size_t first, unsigned int count) {
+    unsigned long long hash = (FNV_OFFSET ^ seed) * FNV_PRIME;
+    for (size_t i = first; i < first + count; i++) {
+      hash ^= blockHashes[i];
+      hash *= FNV_PRIME;
+    }
+    return finalise(hash);
+  }
+
+}
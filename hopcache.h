@@ -0,0 +1,74 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#ifndef HOPCACHE_H
+#define HOPCACHE_H
+
+#include "constants.h"
+#include <list>
+#include <unordered_map>
+
+namespace KeyFinder {
+
+  // Chroma rows keyed by a hash of the preprocessed samples that produced
+  // them. Kept across analyses of edited versions of the same track, it lets
+  // the spectrum analyser skip the FFT for any hop whose input is unchanged,
+  // wherever it has moved to, as long as it still falls on a hop boundary.
+  // Rows are keyed by a fast hash of each block and checked against a
+  // second, separately seeded one that fully mixes every sample, so a
+  // collision in the key is a miss rather than a wrong row.
+  // At most `capacity` rows are kept (under 1 kB each); once full, the
+  // least recently used row is evicted.
+  class HopCache {
+  public:
+    static const unsigned int DEFAULT_CAPACITY = 16384;
+    HopCache(unsigned int capacity = DEFAULT_CAPACITY);
+    bool lookup(unsigned long long hash, unsigned long long check, std::vector<double>& chroma);
+    void store(unsigned long long hash, unsigned long long check, const std::vector<double>& chroma);
+    void clear();
+    void setCapacity(unsigned int capacity);
+    unsigned int getCapacity() const;
+    unsigned int getSize() const;
+    unsigned long long getHits() const;
+    unsigned long long getMisses() const;
+    unsigned long long getEvictions() const;
+    static unsigned long long hashOfBlock(const double* samples, unsigned int count);
+    static unsigned long long checkOfBlock(const double* samples, unsigned int count);
+    static unsigned long long combine(unsigned long long seed, const std::vector<unsigned long long>& blockHashes, size_t first, unsigned int count);
+  private:
+    struct Row {
+      unsigned long long hash;
+      unsigned long long check;
+      std::vector<double> chroma;
+    };
+    void evict();
+    unsigned int capacity;
+    std::list<Row> rows; // most recently used first
+    std::unordered_map< unsigned long long, std::list<Row>::iterator > index;
+    unsigned long long hits;
+    unsigned long long misses;
+    unsigned long long evictions;
+    mutable std::mutex hopCacheMutex;
+  };
+
+}
+
+#endif
@@ -0,0 +1,100 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#include "hopfeatures.h"
+
+namespace KeyFinder {
+
+  static const char* FEATURE_NAMES[] = { "rms", "peak", "flatness", "centroid", "energy" };
+
+  HopFeatures::HopFeatures(size_t hops) : featureData(hops, std::vector<double>(FEATURES, 0.0)) { }
+
+  double HopFeatures::getFeature(size_t hop, hop_feature_t feature) const {
+    if (hop >= getHops()) {
+      std::ostringstream ss;
+      ss << "Cannot get feature of out-of-bounds hop (" << hop << "/" << getHops() << ")";
+      throw Exception(ss.str().c_str());
+    }
+    if (feature >= FEATURES) {
+      std::ostringstream ss;
+      ss << "Cannot get out-of-bounds feature (" << feature << "/" << FEATURES << ")";
+      throw Exception(ss.str().c_str());
+    }
+    return featureData[hop][feature];
+  }
+
+  void HopFeatures::setFeature(size_t hop, hop_feature_t feature, double value) {
+    if (hop >= getHops()) {
+      std::ostringstream ss;
+      ss << "Cannot set feature of out-of-bounds hop (" << hop << "/" << getHops() << ")";
+      throw Exception(ss.str().c_str());
+    }
+    if (feature >= FEATURES) {
+      std::ostringstream ss;
+      ss << "Cannot set out-of-bounds feature (" << feature << "/" << FEATURES << ")";
+      throw Exception(ss.str().c_str());
+    }
+    if (!std::isfinite(value)) {
+      throw Exception("Cannot set feature to NaN");
+    }
+    featureData[hop][feature] = value;
+  }
+
+  void HopFeatures::setSpectralFeatures(size_t hop, const std::vector<double>& magnitudes, unsigned int frameRate, unsigned int frameSize) {
+    // a floor on each bin's power keeps silence and empty bins out of log(0)
+    const double powerFloor = 1e-20;
+    double energy = 0.0;
+    double weightedFrequency = 0.0;
+    double sumOfMagnitudes = 0.0;
+    double sumOfLogs = 0.0;
+    double binWidth = frameRate / (double)frameSize;
+    for (unsigned int bin = 0; bin < magnitudes.size(); bin++) {
+      double magnitude = magnitudes[bin];
+      double power = magnitude * magnitude;
+      energy += power;
+      weightedFrequency += bin * binWidth * magnitude;
+      sumOfMagnitudes += magnitude;
+      sumOfLogs += log(power + powerFloor);
+    }
+    double bins = magnitudes.size();
+    double arithmeticMean = energy / bins + powerFloor;
+    double geometricMean = exp(sumOfLogs / bins);
+    setFeature(hop, FEATURE_FLATNESS, std::min(1.0, geometricMean / arithmeticMean));
+    setFeature(hop, FEATURE_CENTROID, sumOfMagnitudes > 0.0 ? weightedFrequency / sumOfMagnitudes : 0.0);
+    setFeature(hop, FEATURE_ENERGY, energy);
+  }
+
+  void HopFeatures::append(const HopFeatures& that) {
+    featureData.insert(featureData.end(), that.featureData.begin(), that.featureData.end());
+  }
+
+  size_t HopFeatures::getHops() const {
+    return featureData.size();
+  }
+
+  const char* HopFeatures::featureName(hop_feature_t feature) {
+    if (feature >= FEATURES) {
+      throw Exception("No such hop feature");
+    }
+    return FEATURE_NAMES[feature];
+  }
+
+}
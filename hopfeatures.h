@@ -0,0 +1,57 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#ifndef HOPFEATURES_H
+#define HOPFEATURES_H
+
+#include "constants.h"
+
+namespace KeyFinder {
+
+  enum hop_feature_t {
+    FEATURE_RMS,      // of the frame's preprocessed samples, before windowing
+    FEATURE_PEAK,     // absolute, likewise
+    FEATURE_FLATNESS, // geometric over arithmetic mean of the power spectrum
+    FEATURE_CENTROID, // magnitude-weighted mean frequency, in Hz
+    FEATURE_ENERGY,   // sum of squared magnitudes
+    FEATURES
+  };
+
+  // Loudness and tonality features for each hop, row for row alongside the
+  // chromagram, taken from the samples and spectrum the analyser reads
+  // anyway. Filled in by KeyFinder when a workspace points at one from its
+  // first call.
+  class HopFeatures {
+  public:
+    HopFeatures(size_t hops = 0);
+    void append(const HopFeatures& that);
+    void setFeature(size_t hop, hop_feature_t feature, double value);
+    double getFeature(size_t hop, hop_feature_t feature) const;
+    size_t getHops() const;
+    void setSpectralFeatures(size_t hop, const std::vector<double>& magnitudes, unsigned int frameRate, unsigned int frameSize);
+    static const char* featureName(hop_feature_t feature);
+  private:
+    std::vector< std::vector<double> > featureData;
+  };
+
+}
+
+#endif
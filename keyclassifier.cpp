@@ -44,20 +44,22 @@ namespace KeyFinder {
     delete silence;
   }
 
-  key_t KeyClassifier::classify(const std::vector<double>& chromaVector) {
-    std::vector<double> scores(24);
-    double bestScore = 0.0;
+  std::vector<double> KeyClassifier::scores(const std::vector<double>& chromaVector) const {
+    std::vector<double> scores(KEYS + 1);
     for (unsigned int i = 0; i < SEMITONES; i++) {
-      double score;
-      score = major->cosineSimilarity(chromaVector, i); // major
-      scores[i*2] = score;
-      score = minor->cosineSimilarity(chromaVector, i); // minor
-      scores[(i*2)+1] = score;
+      scores[i*2] = major->cosineSimilarity(chromaVector, i); // major
+      scores[(i*2)+1] = minor->cosineSimilarity(chromaVector, i); // minor
     }
-    bestScore = silence->cosineSimilarity(chromaVector, 0);
+    scores[SILENCE] = silence->cosineSimilarity(chromaVector, 0);
+    return scores;
+  }
+
+  key_t KeyClassifier::classify(const std::vector<double>& chromaVector) {
+    std::vector<double> scores = this->scores(chromaVector);
     // find best match, defaulting to silence
+    double bestScore = scores[SILENCE];
     key_t bestMatch = SILENCE;
-    for (unsigned int i = 0; i < 24; i++) {
+    for (unsigned int i = 0; i < KEYS; i++) {
       if (scores[i] > bestScore) {
         bestScore = scores[i];
         bestMatch = (key_t)i;
@@ -66,4 +68,70 @@ namespace KeyFinder {
     return bestMatch;
   }
 
+  ToneProfileSet::ToneProfileSet(const std::vector<double>& inMajorProfile, const std::vector<double>& inMinorProfile) : majorProfile(inMajorProfile), minorProfile(inMinorProfile) {
+    if (majorProfile.size() != BANDS || minorProfile.size() != BANDS) {
+      throw Exception("Tone profile must have 72 elements");
+    }
+  }
+
+  StackedKeyClassifier::StackedKeyClassifier(const std::vector<ToneProfileSet>& profileSets) {
+    profileSetCount = profileSets.size();
+    rows.resize(profileSetCount * KEYS * BANDS);
+    rowNorms.resize(profileSetCount * KEYS);
+    for (unsigned int p = 0; p < profileSetCount; p++) {
+      for (unsigned int k = 0; k < KEYS; k++) {
+        const std::vector<double>& profile = (k % 2 == 0) ? profileSets[p].majorProfile : profileSets[p].minorProfile;
+        unsigned int offset = k / 2;
+        unsigned int row = p * KEYS + k;
+        double norm = 0.0;
+        for (unsigned int o = 0; o < OCTAVES; o++) {
+          for (unsigned int s = 0; s < SEMITONES; s++) {
+            // the same rotation as ToneProfile: profiles start at A, bands at C
+            double weight = profile[o * SEMITONES + (s + 3 + SEMITONES * 2 - offset) % SEMITONES];
+            rows[row * BANDS + o * SEMITONES + s] = weight;
+            norm += pow(weight, 2);
+          }
+        }
+        rowNorms[row] = sqrt(norm);
+      }
+    }
+  }
+
+  unsigned int StackedKeyClassifier::getProfileSetCount() const {
+    return profileSetCount;
+  }
+
+  std::vector<key_t> StackedKeyClassifier::classify(const std::vector<double>& chromaVector) const {
+
+    if (chromaVector.size() != BANDS) {
+      throw Exception("Chroma data must have 72 elements");
+    }
+
+    double inputNorm = 0.0;
+    for (unsigned int b = 0; b < BANDS; b++) {
+      inputNorm += pow(chromaVector[b], 2);
+    }
+    inputNorm = sqrt(inputNorm);
+
+    std::vector<key_t> keys(profileSetCount, SILENCE);
+    std::vector<double>::const_iterator rowIt = rows.begin();
+    for (unsigned int p = 0; p < profileSetCount; p++) {
+      double bestScore = 0.0; // silence
+      for (unsigned int k = 0; k < KEYS; k++) {
+        double intersection = 0.0;
+        for (unsigned int b = 0; b < BANDS; b++) {
+          intersection += chromaVector[b] * *rowIt;
+          std::advance(rowIt, 1);
+        }
+        double rowNorm = rowNorms[p * KEYS + k];
+        double score = (rowNorm > 0 && inputNorm > 0) ? intersection / (rowNorm * inputNorm) : 0.0;
+        if (score > bestScore) {
+          bestScore = score;
+          keys[p] = (key_t)k;
+        }
+      }
+    }
+    return keys;
+  }
+
 }
@@ -32,12 +32,34 @@ namespace KeyFinder {
     KeyClassifier(const std::vector<double>& majorProfile, const std::vector<double>& minorProfile);
     ~KeyClassifier();
     key_t classify(const std::vector<double>& chromaVector);
+    std::vector<double> scores(const std::vector<double>& chromaVector) const; // indexed by key_t, including SILENCE
   private:
     ToneProfile* major;
     ToneProfile* minor;
     ToneProfile* silence;
   };
 
+  class ToneProfileSet {
+  public:
+    ToneProfileSet(const std::vector<double>& majorProfile, const std::vector<double>& minorProfile);
+    std::vector<double> majorProfile;
+    std::vector<double> minorProfile;
+  };
+
+  // Classifies against several profile sets at once. Every rotation of every
+  // profile is precompiled into one matrix, so each extra set costs only
+  // another KEYS rows of dot products; results match KeyClassifier exactly.
+  class StackedKeyClassifier {
+  public:
+    StackedKeyClassifier(const std::vector<ToneProfileSet>& profileSets);
+    unsigned int getProfileSetCount() const;
+    std::vector<key_t> classify(const std::vector<double>& chromaVector) const;
+  private:
+    unsigned int profileSetCount;
+    std::vector<double> rows;     // (profileSetCount * KEYS) x BANDS
+    std::vector<double> rowNorms;
+  };
+
 }
 
 #endif
@@ -21,39 +21,454 @@
 
 #include "keyfinder.h"
 
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <thread>
+
 namespace KeyFinder {
 
+  KeyFinder::KeyFinder() : executionDomain(NULL), peekFftAdapter(NULL) { }
+
+  KeyFinder::~KeyFinder() {
+    if (peekFftAdapter != NULL) {
+      delete peekFftAdapter;
+    }
+  }
+
   key_t KeyFinder::keyOfAudio(const AudioData& originalAudio) {
+    return keyOfChromaVector(chromaVectorOfAudio(originalAudio));
+  }
+
+  key_t KeyFinder::keyOfAudio(const AudioData& originalAudio, AnalysisDiagnostics& diagnostics) {
+    std::vector<double> chromaVector = chromaVectorOfAudio(originalAudio, NULL, &diagnostics);
+    std::chrono::steady_clock::time_point mark = std::chrono::steady_clock::now();
+    key_t key = keyOfChromaVector(chromaVector);
+    diagnostics.lap(STAGE_CLASSIFY, mark);
+    return key;
+  }
+
+  key_t KeyFinder::keyOfAudio(const AudioData& originalAudio, HopCache& cache) {
+    return keyOfChromaVector(chromaVectorOfAudio(originalAudio, &cache));
+  }
+
+  key_t KeyFinder::keyOfAudio(const AudioData& originalAudio, ChromaFingerprint& fingerprint) {
+    return keyOfChromaVector(chromaVectorOfAudio(originalAudio, NULL, NULL, &fingerprint));
+  }
+
+  key_t KeyFinder::keyOfAudio(const AudioData& originalAudio, TonalityGate& gate, TonalityVerdict& verdict) {
+    verdict = gate.assess(originalAudio);
+    if (verdict.atonal) {
+      return SILENCE;
+    }
+    return keyOfAudio(originalAudio);
+  }
+
+  std::vector<key_t> KeyFinder::keyOfAudio(const AudioData& originalAudio, const StackedKeyClassifier& classifier) {
+    return classifier.classify(chromaVectorOfAudio(originalAudio));
+  }
+
+  std::vector<double> KeyFinder::chromaVectorOfAudio(const AudioData& originalAudio, HopCache* cache, AnalysisDiagnostics* diagnostics, ChromaFingerprint* fingerprint) {
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
 
     Workspace workspace;
+    workspace.hopCache = cache;
+    workspace.diagnostics = diagnostics;
+    workspace.fingerprint = fingerprint;
     progressiveChromagram(originalAudio, workspace);
     finalChromagram(workspace);
 
+    std::vector<double> chromaVector = workspace.chromagram->collapseToOneHop();
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (cache != NULL) {
+      // cache hits would skew the calibration, and the shadow timings
+      return chromaVector;
+    }
+    costEstimator.observe(estimateCost(originalAudio.getFrameCount(), originalAudio.getChannels(), originalAudio.getFrameRate()), elapsed.count());
+
+    if (shadowEvaluator.sample()) {
+      shadowEvaluator.evaluate(originalAudio, chromaVector, elapsed.count());
+    }
+
+    return chromaVector;
+  }
+
+  ChannelKeys KeyFinder::keyOfChannels(const AudioData& originalAudio, channel_analysis_t analysis) {
+
+    unsigned int channels = originalAudio.getChannels();
+    std::vector< std::vector<double> > mixes;
+    if (analysis == CHANNELS_MID_SIDE) {
+      if (channels != 2) {
+        throw Exception("Mid/side analysis needs stereo audio");
+      }
+      mixes.push_back(std::vector<double>(2, 0.5));
+      mixes.push_back(std::vector<double>(2, 0.5));
+      mixes.back()[1] = -0.5;
+    } else {
+      for (unsigned int c = 0; c < channels; c++) {
+        mixes.push_back(std::vector<double>(channels, 0.0));
+        mixes.back()[c] = 1.0;
+      }
+    }
+
+    // build the filter, kernel and window once up front rather than in each
+    // stream, and hold them until every stream is done so that the registry
+    // can't evict them in between
+    unsigned int frameRate = originalAudio.getFrameRate();
+    std::shared_ptr<const LowPassFilter> lpf = lpfFactory.getLowPassFilter(LPFORDER, frameRate, getLastFrequency() * 1.012, LPFFFTFRAMESIZE);
+    std::shared_ptr<const ChromaTransform> ct = ctFactory.getChromaTransform(frameRate / getDownsampleFactor(frameRate));
+    std::shared_ptr<const std::vector<double> > tw = twFactory.getTemporalWindow(FFTFRAMESIZE);
+    prewarm(frameRate);
+
+    // the mono mix is analysed as one more stream, unless it's the mid channel
+    bool monoIsMid = (analysis == CHANNELS_MID_SIDE);
+    unsigned int streamCount = mixes.size() + (monoIsMid ? 0 : 1);
+    std::vector< std::vector<double> > chromaVectors(streamCount);
+    std::vector<std::exception_ptr> failures(streamCount);
+
+    std::function<void(unsigned int)> analyseStream = [this, &originalAudio, &mixes, &chromaVectors, &failures](unsigned int s) {
+      try {
+        Workspace workspace;
+        if (s < mixes.size()) {
+          AudioData* stream = originalAudio.mixToMono(mixes[s]);
+          progressiveChromagram(*stream, workspace);
+          delete stream;
+        } else {
+          progressiveChromagram(originalAudio, workspace);
+        }
+        finalChromagram(workspace);
+        chromaVectors[s] = workspace.chromagram->collapseToOneHop();
+      } catch (...) {
+        failures[s] = std::current_exception();
+      }
+    };
+
+    if (executionDomain != NULL && executionDomain->isCurrent()) {
+      // already on one of the domain's workers, which may be its only one
+      for (unsigned int s = 0; s < streamCount; s++) {
+        analyseStream(s);
+      }
+    } else if (executionDomain != NULL) {
+      std::vector< std::future<void> > streams;
+      for (unsigned int s = 0; s < streamCount; s++) {
+        streams.push_back(executionDomain->submit(std::bind(analyseStream, s)));
+      }
+      for (unsigned int s = 0; s < streams.size(); s++) {
+        streams[s].get();
+      }
+    } else {
+      std::vector<std::thread> threads;
+      for (unsigned int s = 0; s < streamCount; s++) {
+        threads.push_back(std::thread(analyseStream, s));
+      }
+      for (unsigned int s = 0; s < threads.size(); s++) {
+        threads[s].join();
+      }
+    }
+    for (unsigned int s = 0; s < failures.size(); s++) {
+      if (failures[s]) {
+        std::rethrow_exception(failures[s]);
+      }
+    }
+
+    ChannelKeys result;
+    for (unsigned int s = 0; s < mixes.size(); s++) {
+      result.keys.push_back(keyOfChromaVector(chromaVectors[s]));
+      result.chromaVectors.push_back(chromaVectors[s]);
+    }
+    result.mono = monoIsMid ? result.keys[0] : keyOfChromaVector(chromaVectors.back());
+    return result;
+  }
+
+  void KeyFinder::setShadowSampling(unsigned int oneInN) {
+    shadowEvaluator.setSampling(oneInN);
+  }
+
+  ShadowStatistics KeyFinder::getShadowStatistics() const {
+    return shadowEvaluator.getStatistics();
+  }
+
+  void KeyFinder::waitForShadowEvaluations() {
+    shadowEvaluator.wait();
+  }
+
+  void KeyFinder::setExecutionDomain(ExecutionDomain* domain) {
+    executionDomain = domain;
+    shadowEvaluator.setExecutionDomain(domain);
+  }
+
+  CostEstimate KeyFinder::estimateCost(size_t frames, unsigned int channels, unsigned int frameRate) const {
+    return costEstimator.estimate(frames, channels, frameRate, getDownsampleFactor(frameRate));
+  }
+
+  key_t KeyFinder::keyOfRegion(const AudioData& originalAudio, double startSeconds, double endSeconds) {
+
+    if (startSeconds < 0.0 || endSeconds <= startSeconds) {
+      throw Exception("Region must start at or after zero and end after its start");
+    }
+
+    unsigned int frameRate = originalAudio.getFrameRate();
+    size_t frameCount = originalAudio.getFrameCount();
+    size_t startFrame = floor(startSeconds * frameRate);
+    size_t endFrame = std::min((double)frameCount, ceil(endSeconds * frameRate));
+    if (startFrame >= endFrame) {
+      throw Exception("Region lies outside the audio");
+    }
+    size_t regionFrames = endFrame - startFrame;
+
+    // read enough audio either side of the region to settle the low pass
+    // filter, keeping the lead-in a whole number of decimation steps so that
+    // it can be discarded exactly after downsampling.
+    unsigned int downsampleFactor = getDownsampleFactor(frameRate);
+    size_t leadIn = std::min<size_t>(LPFORDER / 2 + downsampleFactor - 1, startFrame);
+    leadIn -= leadIn % downsampleFactor;
+    size_t leadOut = std::min<size_t>(LPFORDER / 2, frameCount - endFrame);
+
+    AudioData* region = originalAudio.copyFrames(startFrame - leadIn, leadIn + regionFrames + leadOut);
+    Workspace workspace;
+    preprocess(*region, workspace, true);
+
+    region->discardFramesFromFront(leadIn / downsampleFactor);
+    size_t keepSamples = (regionFrames + downsampleFactor - 1) / downsampleFactor;
+    if (region->getSampleCount() > keepSamples) {
+      delete region->sliceSamplesFromBack(region->getSampleCount() - keepSamples);
+    }
+    workspace.preprocessedBuffer.append(*region);
+    delete region;
+
+    finalChromagram(workspace);
+
     return keyOfChromaVector(workspace.chromagram->collapseToOneHop());
   }
 
+  // the clock is only read when someone is listening
+  static bool isTimed(const Workspace& workspace) {
+    return workspace.recorder != NULL || workspace.metrics != NULL;
+  }
+
+  static void countProgressiveCall(Workspace& workspace, size_t frames, unsigned int channels, unsigned int frameRate) {
+    if (workspace.diagnostics != NULL) {
+      workspace.diagnostics->frameRate = frameRate;
+      workspace.diagnostics->channels = channels;
+      workspace.diagnostics->frames += frames;
+      workspace.diagnostics->calls++;
+    }
+  }
+
+  static void recordProgressiveCall(Workspace& workspace, workload_call_t call, size_t frames, unsigned int channels, unsigned int frameRate, unsigned int frameSize, size_t hopsBefore, std::chrono::steady_clock::time_point start) {
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    if (workspace.recorder != NULL) {
+      workspace.recorder->record(call, frames, channels, frameRate, start, end, frameSize);
+    }
+    if (workspace.metrics != NULL) {
+      workspace.metrics->progressiveChromagram.record(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+      workspace.metrics->hopsPerCall.record(workspace.chromagram != NULL ? workspace.chromagram->getHops() - hopsBefore : 0);
+    }
+  }
+
   void KeyFinder::progressiveChromagram(AudioData audio, Workspace& workspace) {
+    bool timed = isTimed(workspace);
+    std::chrono::steady_clock::time_point start;
+    if (timed) {
+      start = std::chrono::steady_clock::now();
+    }
+    unsigned int channels = audio.getChannels();
+    size_t frames = channels > 0 ? audio.getSampleCount() / channels : 0;
+    unsigned int frameRate = audio.getFrameRate();
+    size_t hops = workspace.chromagram != NULL ? workspace.chromagram->getHops() : 0;
+    countProgressiveCall(workspace, frames, channels, frameRate);
+
     preprocess(audio, workspace);
     workspace.preprocessedBuffer.append(audio);
     chromagramOfBufferedAudio(workspace);
+
+    if (timed) {
+      recordProgressiveCall(workspace, CALL_PROGRESSIVE_CHROMAGRAM, frames, channels, frameRate, 0, hops, start);
+    }
+  }
+
+  void KeyFinder::progressiveChromagramAtAnalysisRate(AudioData audio, Workspace& workspace) {
+    if (audio.getChannels() != 1) {
+      throw Exception("Analysis-rate audio must be monophonic");
+    }
+    bool timed = isTimed(workspace);
+    std::chrono::steady_clock::time_point start;
+    if (timed) {
+      start = std::chrono::steady_clock::now();
+    }
+    size_t frames = audio.getFrameCount();
+    size_t hops = workspace.chromagram != NULL ? workspace.chromagram->getHops() : 0;
+    countProgressiveCall(workspace, frames, 1, audio.getFrameRate());
+    if (workspace.diagnostics != NULL) {
+      workspace.diagnostics->downsampleFactor = 1;
+    }
+
+    workspace.preprocessedBuffer.append(audio);
+    chromagramOfBufferedAudio(workspace);
+
+    if (timed) {
+      recordProgressiveCall(workspace, CALL_ANALYSIS_RATE_CHROMAGRAM, frames, 1, audio.getFrameRate(), 0, hops, start);
+    }
+  }
+
+  key_t KeyFinder::keyOfAudioAtAnalysisRate(const AudioData& audio) {
+    Workspace workspace;
+    progressiveChromagramAtAnalysisRate(audio, workspace);
+    finalChromagram(workspace);
+    return keyOfChromaVector(workspace.chromagram->collapseToOneHop());
+  }
+
+  void KeyFinder::progressiveChromagramOfSpectra(const std::vector< std::vector<double> >& spectra, unsigned int frameSize, unsigned int frameRate, Workspace& workspace) {
+    bool timed = isTimed(workspace);
+    std::chrono::steady_clock::time_point start;
+    if (timed) {
+      start = std::chrono::steady_clock::now();
+    }
+    size_t hops = workspace.chromagram != NULL ? workspace.chromagram->getHops() : 0;
+    // spectra stand in for the audio, so only the call is counted
+    countProgressiveCall(workspace, 0, 0, frameRate);
+    std::chrono::steady_clock::time_point mark;
+    if (workspace.diagnostics != NULL) {
+      mark = std::chrono::steady_clock::now();
+    }
+
+    std::shared_ptr<const ChromaTransform> ct = ctFactory.getChromaTransform(frameRate, frameSize);
+    std::vector< std::vector<double> > chromaVectors(spectra.size());
+    for (unsigned int hop = 0; hop < spectra.size(); hop++) {
+      chromaVectors[hop] = ct->chromaVector(spectra[hop]);
+    }
+    Chromagram* c = new Chromagram(spectra.size());
+    for (unsigned int hop = 0; hop < spectra.size(); hop++) {
+      for (unsigned int band = 0; band < BANDS; band++) {
+        c->setMagnitude(hop, band, chromaVectors[hop][band]);
+      }
+    }
+    if (workspace.fingerprint != NULL) {
+      workspace.fingerprint->append(*c);
+    }
+    if (workspace.features != NULL) {
+      // there are no samples, so RMS and peak are left at zero
+      HopFeatures features(spectra.size());
+      for (unsigned int hop = 0; hop < spectra.size(); hop++) {
+        features.setSpectralFeatures(hop, spectra[hop], frameRate, frameSize);
+      }
+      workspace.features->append(features);
+    }
+    if (workspace.diagnostics != NULL) {
+      workspace.diagnostics->lap(STAGE_SPECTRUM, mark);
+      workspace.diagnostics->hops += c->getHops();
+    }
+    if (workspace.chromagram == NULL) {
+      workspace.chromagram = c;
+    } else {
+      workspace.chromagram->append(*c);
+      delete c;
+    }
+
+    if (timed) {
+      recordProgressiveCall(workspace, CALL_SPECTRA_CHROMAGRAM, spectra.size(), 0, frameRate, frameSize, hops, start);
+    }
+  }
+
+  key_t KeyFinder::keyOfSpectra(const std::vector< std::vector<double> >& spectra, unsigned int frameSize, unsigned int frameRate) {
+    Workspace workspace;
+    progressiveChromagramOfSpectra(spectra, frameSize, frameRate, workspace);
+    return keyOfChromaVector(workspace.chromagram->collapseToOneHop());
   }
 
   void KeyFinder::finalChromagram(Workspace& workspace) {
+    bool timed = isTimed(workspace);
+    std::chrono::steady_clock::time_point start;
+    if (timed) {
+      start = std::chrono::steady_clock::now();
+    }
     // flush remainder buffer
     if (workspace.remainderBuffer.getSampleCount() > 0) {
       AudioData flush;
       preprocess(flush, workspace, true);
     }
-    // zero padding
-    unsigned int paddedHopCount = ceil(workspace.preprocessedBuffer.getSampleCount() / (double)HOPSIZE);
-    unsigned int finalSampleLength = FFTFRAMESIZE + ((paddedHopCount - 1) * HOPSIZE);
-    workspace.preprocessedBuffer.addToSampleCount(finalSampleLength - workspace.preprocessedBuffer.getSampleCount());
+    // zero padding, in integers so that long streams lose no precision
+    size_t bufferedSamples = workspace.preprocessedBuffer.getSampleCount();
+    size_t paddedHopCount = bufferedSamples / HOPSIZE + (bufferedSamples % HOPSIZE > 0 ? 1 : 0);
+    if (paddedHopCount > 0) {
+      size_t finalSampleLength = FFTFRAMESIZE + ((paddedHopCount - 1) * HOPSIZE);
+      if (workspace.diagnostics != NULL) {
+        workspace.diagnostics->paddingSamples += finalSampleLength - bufferedSamples;
+      }
+      workspace.preprocessedBuffer.addToSampleCount(finalSampleLength - bufferedSamples);
+    }
     chromagramOfBufferedAudio(workspace);
+
+    if (!timed) {
+      return;
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    if (workspace.recorder != NULL) {
+      workspace.recorder->record(CALL_FINAL_CHROMAGRAM, 0, 0, 0, start, end);
+    }
+    if (workspace.metrics != NULL) {
+      workspace.metrics->finalChromagram.record(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    }
+  }
+
+  key_t KeyFinder::peekKey(const Workspace& workspace) {
+
+    // copy the buffered audio into a scratch workspace, which has its own FFT
+    // adapter and filter buffer, so that flushing it leaves the real one alone.
+    // The adapter is borrowed from the last peek, so its plan is only made
+    // once; a peek that finds it already borrowed plans its own.
+    Workspace scratch;
+    scratch.remainderBuffer = workspace.remainderBuffer;
+    scratch.preprocessedBuffer = workspace.preprocessedBuffer;
+    {
+      std::lock_guard<std::mutex> lock(keyFinderMutex);
+      scratch.fftAdapter = peekFftAdapter;
+      peekFftAdapter = NULL;
+    }
+
+    std::vector<double> chromaVector(BANDS, 0.0);
+    size_t hops = 0;
+
+    if (workspace.chromagram != NULL && workspace.chromagram->getHops() > 0) {
+      chromaVector = workspace.chromagram->collapseToOneHop();
+      hops = workspace.chromagram->getHops();
+    }
+
+    if (scratch.remainderBuffer.getSampleCount() > 0 || scratch.preprocessedBuffer.getSampleCount() > 0) {
+      finalChromagram(scratch);
+      // combine the means of the committed and provisional hops
+      std::vector<double> tail = scratch.chromagram->collapseToOneHop();
+      size_t tailHops = scratch.chromagram->getHops();
+      for (unsigned int b = 0; b < BANDS; b++) {
+        chromaVector[b] = (chromaVector[b] * hops + tail[b] * tailHops) / (hops + tailHops);
+      }
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(keyFinderMutex);
+      if (peekFftAdapter == NULL) {
+        peekFftAdapter = scratch.fftAdapter;
+        scratch.fftAdapter = NULL;
+      }
+    }
+
+    return keyOfChromaVector(chromaVector);
   }
 
   void KeyFinder::preprocess(AudioData& workingAudio, Workspace& workspace, bool flushRemainderBuffer) {
 
+    AnalysisDiagnostics* diagnostics = workspace.diagnostics;
+    std::chrono::steady_clock::time_point mark;
+    if (diagnostics != NULL) {
+      mark = std::chrono::steady_clock::now();
+    }
+
     workingAudio.reduceToMono();
+    if (diagnostics != NULL) {
+      diagnostics->lap(STAGE_MONO, mark);
+    }
 
     if (workspace.remainderBuffer.getChannels() > 0) {
       workingAudio.prepend(workspace.remainderBuffer);
@@ -62,30 +477,85 @@ namespace KeyFinder {
 
     // TODO: there is presumably some good maths to determine filter frequencies. For now, this approximates original experiment values.
     double lpfCutoff = getLastFrequency() * 1.012;
-    double dsCutoff = getLastFrequency() * 1.10;
-    unsigned int downsampleFactor = (int) floor(workingAudio.getFrameRate() / 2 / dsCutoff);
+    unsigned int downsampleFactor = getDownsampleFactor(workingAudio.getFrameRate());
 
-    unsigned int bufferExcess = workingAudio.getSampleCount() % downsampleFactor;
+    size_t bufferExcess = workingAudio.getSampleCount() % downsampleFactor;
     if (!flushRemainderBuffer && bufferExcess != 0) {
       AudioData* remainder = workingAudio.sliceSamplesFromBack(bufferExcess);
       workspace.remainderBuffer.append(*remainder);
       delete remainder;
     }
 
-    const LowPassFilter* lpf = lpfFactory.getLowPassFilter(160, workingAudio.getFrameRate(), lpfCutoff, 2048);
-    lpf->filter(workingAudio, workspace, downsampleFactor);
-    // note we don't delete the LPF; it's stored in the factory for reuse
+    if (diagnostics != NULL) {
+      diagnostics->downsampleFactor = downsampleFactor;
+      diagnostics->filterTaps = LPFORDER + 1;
+      diagnostics->filterShortcut = downsampleFactor > 1;
+      diagnostics->maxRemainderSamples = std::max(diagnostics->maxRemainderSamples, workspace.remainderBuffer.getSampleCount());
+      mark = std::chrono::steady_clock::now();
+    }
+
+    // the workspace holds on to its filter, so streams don't go back to the registry for every packet
+    if (workspace.lowPassFilter == NULL || workspace.lowPassFilter->getFrameRate() != workingAudio.getFrameRate()) {
+      workspace.lowPassFilter = lpfFactory.getLowPassFilter(LPFORDER, workingAudio.getFrameRate(), lpfCutoff, LPFFFTFRAMESIZE);
+    }
+    workspace.lowPassFilter->filter(workingAudio, workspace, downsampleFactor);
+    if (diagnostics != NULL) {
+      diagnostics->lap(STAGE_LOWPASS, mark);
+    }
 
     workingAudio.downsample(downsampleFactor);
+    if (diagnostics != NULL) {
+      diagnostics->lap(STAGE_DOWNSAMPLE, mark);
+    }
+  }
+
+  void KeyFinder::prewarm(unsigned int frameRate) {
+    unsigned int downsampleFactor = getDownsampleFactor(frameRate);
+    lpfFactory.getLowPassFilter(LPFORDER, frameRate, getLastFrequency() * 1.012, LPFFFTFRAMESIZE);
+    ctFactory.getChromaTransform(frameRate / downsampleFactor);
+    twFactory.getTemporalWindow(FFTFRAMESIZE);
+    toneProfileMajor();
+    toneProfileMinor();
+    // the filter, kernel and window stay in the PlanRegistry. FFT plans
+    // don't: each workspace plans its own, so this one only helps when
+    // measuring is on, by leaving wisdom for later workspaces to plan from
+    FftAdapter fft(FFTFRAMESIZE);
   }
 
   void KeyFinder::chromagramOfBufferedAudio(Workspace& workspace) {
     if (workspace.fftAdapter == NULL) {
       workspace.fftAdapter = new FftAdapter(FFTFRAMESIZE);
     }
-    SpectrumAnalyser sa(workspace.preprocessedBuffer.getFrameRate(), &ctFactory, &twFactory);
-    Chromagram* c = sa.chromagramOfWholeFrames(workspace.preprocessedBuffer, workspace.fftAdapter);
+    AnalysisDiagnostics* diagnostics = workspace.diagnostics;
+    std::chrono::steady_clock::time_point mark;
+    if (diagnostics != NULL) {
+      mark = std::chrono::steady_clock::now();
+    }
+    unsigned long long cacheHits = workspace.hopCache != NULL ? workspace.hopCache->getHits() : 0;
+
+    unsigned int frameRate = workspace.preprocessedBuffer.getFrameRate();
+    if (workspace.chromaTransform == NULL || workspace.chromaTransform->getFrameRate() != frameRate || workspace.chromaTransform->getFrameSize() != FFTFRAMESIZE) {
+      workspace.chromaTransform = ctFactory.getChromaTransform(frameRate);
+    }
+    if (workspace.temporalWindow == NULL) {
+      workspace.temporalWindow = twFactory.getTemporalWindow(FFTFRAMESIZE);
+    }
+    SpectrumAnalyser sa(frameRate, workspace.chromaTransform, workspace.temporalWindow);
+    Chromagram* c = sa.chromagramOfWholeFrames(workspace.preprocessedBuffer, workspace.fftAdapter, workspace.hopCache, workspace.features);
+
+    if (diagnostics != NULL) {
+      diagnostics->lap(STAGE_SPECTRUM, mark);
+      diagnostics->fftEngine = std::string("FFTW, ") + workspace.fftAdapter->getPlanning() + " plan";
+      diagnostics->hops += c->getHops();
+      diagnostics->peakBufferedSamples = std::max(diagnostics->peakBufferedSamples, workspace.preprocessedBuffer.getSampleCount());
+      if (workspace.hopCache != NULL) {
+        diagnostics->cachedHops += workspace.hopCache->getHits() - cacheHits;
+      }
+    }
     workspace.preprocessedBuffer.discardFramesFromFront(HOPSIZE * c->getHops());
+    if (workspace.fingerprint != NULL) {
+      workspace.fingerprint->append(*c);
+    }
     if (workspace.chromagram == NULL) {
       workspace.chromagram = c;
     } else {
@@ -105,7 +575,30 @@ namespace KeyFinder {
   }
 
   key_t KeyFinder::keyOfChromagram(const Workspace& workspace) const {
+    bool timed = isTimed(workspace) || workspace.diagnostics != NULL;
+    std::chrono::steady_clock::time_point start;
+    if (timed) {
+      start = std::chrono::steady_clock::now();
+    }
     KeyClassifier classifier(toneProfileMajor(), toneProfileMinor());
+    key_t key = classifier.classify(workspace.chromagram->collapseToOneHop());
+    if (!timed) {
+      return key;
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    if (workspace.diagnostics != NULL) {
+      workspace.diagnostics->stageSeconds[STAGE_CLASSIFY] += std::chrono::duration<double>(end - start).count();
+    }
+    if (workspace.recorder != NULL) {
+      workspace.recorder->record(CALL_KEY_OF_CHROMAGRAM, 0, 0, 0, start, end);
+    }
+    if (workspace.metrics != NULL) {
+      workspace.metrics->keyOfChromagram.record(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    }
+    return key;
+  }
+
+  std::vector<key_t> KeyFinder::keyOfChromagram(const Workspace& workspace, const StackedKeyClassifier& classifier) const {
     return classifier.classify(workspace.chromagram->collapseToOneHop());
   }
 
@@ -23,34 +23,107 @@
 #define KEYFINDER_H
 
 #include "audiodata.h"
+#include "batchjournal.h"
 #include "lowpassfilterfactory.h"
 #include "chromatransformfactory.h"
 #include "spectrumanalyser.h"
 #include "keyclassifier.h"
+#include "costestimator.h"
+#include "shadowevaluator.h"
+#include "executiondomain.h"
+#include "tonalitygate.h"
+#include "arrowexport.h"
+#include <mutex>
 
 namespace KeyFinder {
 
+  class ChannelKeys {
+  public:
+    key_t mono;
+    std::vector<key_t> keys;                         // per channel, or mid then side
+    std::vector< std::vector<double> > chromaVectors; // likewise
+  };
+
   class KeyFinder {
   public:
+    KeyFinder();
+    ~KeyFinder();
 
     // for progressive analysis
     void progressiveChromagram(AudioData audio, Workspace& workspace);
     void finalChromagram(Workspace& workspace);
     key_t keyOfChromagram(const Workspace& workspace) const;
+    key_t peekKey(const Workspace& workspace);
 
     // for analysis of a whole audio file
     key_t keyOfAudio(const AudioData& audio);
 
+    // for mono audio already decimated to an analysis rate, skipping mono
+    // reduction, filtering and downsampling
+    void progressiveChromagramAtAnalysisRate(AudioData audio, Workspace& workspace);
+    key_t keyOfAudioAtAnalysisRate(const AudioData& audio);
+
+    // for magnitude spectra from an external STFT; each frame holds bins 0 to frameSize / 2
+    void progressiveChromagramOfSpectra(const std::vector< std::vector<double> >& spectra, unsigned int frameSize, unsigned int frameRate, Workspace& workspace);
+    key_t keyOfSpectra(const std::vector< std::vector<double> >& spectra, unsigned int frameSize, unsigned int frameRate);
+
+    // for analysis with a record of where the time went, e.g. for slow jobs
+    key_t keyOfAudio(const AudioData& audio, AnalysisDiagnostics& diagnostics);
+
+    // for re-analysis of edited audio; reuses the chroma of unchanged hops
+    key_t keyOfAudio(const AudioData& audio, HopCache& cache);
+
+    // for near-duplicate detection from the same pass; see FingerprintIndex
+    key_t keyOfAudio(const AudioData& audio, ChromaFingerprint& fingerprint);
+
+    // for ingest that mixes music with speech, effects and noise; audio the
+    // gate finds atonal comes back as SILENCE without the full pipeline
+    key_t keyOfAudio(const AudioData& audio, TonalityGate& gate, TonalityVerdict& verdict);
+
+    // for analysis of a section of an audio file, e.g. a chorus or cue range
+    key_t keyOfRegion(const AudioData& audio, double startSeconds, double endSeconds);
+
+    // for paying the one-off setup costs of a frame rate before the first
+    // analysis; best-effort, since nothing holds the plans afterwards, so the
+    // plan registry may evict them again if its memory cap is exceeded
+    void prewarm(unsigned int frameRate);
+
+    // for scheduling; calibrated against observed runs of keyOfAudio
+    CostEstimate estimateCost(size_t frames, unsigned int channels, unsigned int frameRate) const;
+
+    // for analysis of each channel, or of mid and side, alongside the mono mix
+    ChannelKeys keyOfChannels(const AudioData& audio, channel_analysis_t analysis);
+
+    // for comparing keyOfAudio against a reference pipeline in the background
+    void setShadowSampling(unsigned int oneInN);
+    ShadowStatistics getShadowStatistics() const;
+    void waitForShadowEvaluations();
+
+    // for confining keyOfChannels streams and shadow evaluation to a domain;
+    // optional, not owned, and NULL for a thread per stream. Replace or clear
+    // it here before destroying the domain.
+    void setExecutionDomain(ExecutionDomain* domain);
+
     // for experimentation with alternative tone profiles
     key_t keyOfChromaVector(const std::vector<double>& chromaVector, const std::vector<double>& overrideMajorProfile, const std::vector<double>& overrideMinorProfile) const;
 
+    // for comparing several sets of tone profiles in one pass; one key per set
+    std::vector<key_t> keyOfAudio(const AudioData& audio, const StackedKeyClassifier& classifier);
+    std::vector<key_t> keyOfChromagram(const Workspace& workspace, const StackedKeyClassifier& classifier) const;
+
   private:
+    std::vector<double> chromaVectorOfAudio(const AudioData& audio, HopCache* cache = NULL, AnalysisDiagnostics* diagnostics = NULL, ChromaFingerprint* fingerprint = NULL);
     void preprocess(AudioData& workingAudio, Workspace& workspace, bool flushRemainderBuffer = false);
     void chromagramOfBufferedAudio(Workspace& workspace);
     key_t keyOfChromaVector(const std::vector<double>& chromaVector) const;
     LowPassFilterFactory   lpfFactory;
     ChromaTransformFactory ctFactory;
     TemporalWindowFactory  twFactory;
+    CostEstimator          costEstimator;
+    ShadowEvaluator        shadowEvaluator;
+    ExecutionDomain*       executionDomain;
+    FftAdapter*            peekFftAdapter; // kept between peeks, so they don't plan again
+    std::mutex             keyFinderMutex;
   };
 
 }
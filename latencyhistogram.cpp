@@ -0,0 +1,158 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#include "latencyhistogram.h"
+
+namespace KeyFinder {
+
+  LatencyHistogram::LatencyHistogram() {
+    clear();
+  }
+
+  unsigned int LatencyHistogram::bucketOf(unsigned long long value) {
+    if (value < 64) {
+      return (unsigned int)value;
+    }
+    unsigned int magnitude = 6;
+    while (magnitude < 63 && (value >> (magnitude + 1)) != 0) {
+      magnitude++;
+    }
+    unsigned int shift = magnitude - 5;
+    return 64 + (magnitude - 6) * 32 + (unsigned int)((value >> shift) - 32);
+  }
+
+  unsigned long long LatencyHistogram::upperBoundOf(unsigned int bucket) {
+    if (bucket < 64) {
+      return bucket;
+    }
+    unsigned int magnitude = (bucket - 64) / 32 + 6;
+    unsigned long long subBucket = (bucket - 64) % 32 + 32;
+    unsigned int shift = magnitude - 5;
+    if (magnitude == 63 && subBucket == 63) {
+      return ~0ULL;
+    }
+    return ((subBucket + 1) << shift) - 1;
+  }
+
+  void LatencyHistogram::record(unsigned long long value) {
+    counts[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(value, std::memory_order_relaxed);
+    raiseMax(value);
+  }
+
+  void LatencyHistogram::raiseMax(unsigned long long value) {
+    unsigned long long previous = max.load(std::memory_order_relaxed);
+    while (value > previous && !max.compare_exchange_weak(previous, value, std::memory_order_relaxed)) { }
+  }
+
+  void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (unsigned int i = 0; i < BUCKETS; i++) {
+      unsigned long long n = other.counts[i].load(std::memory_order_relaxed);
+      if (n > 0) {
+        counts[i].fetch_add(n, std::memory_order_relaxed);
+      }
+    }
+    count.fetch_add(other.count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    sum.fetch_add(other.sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    raiseMax(other.max.load(std::memory_order_relaxed));
+  }
+
+  void LatencyHistogram::clear() {
+    for (unsigned int i = 0; i < BUCKETS; i++) {
+      counts[i].store(0, std::memory_order_relaxed);
+    }
+    count.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    max.store(0, std::memory_order_relaxed);
+  }
+
+  unsigned long long LatencyHistogram::getCount() const {
+    return count.load(std::memory_order_relaxed);
+  }
+
+  unsigned long long LatencyHistogram::getMax() const {
+    return max.load(std::memory_order_relaxed);
+  }
+
+  double LatencyHistogram::getMean() const {
+    unsigned long long n = getCount();
+    return n == 0 ? 0.0 : sum.load(std::memory_order_relaxed) / (double)n;
+  }
+
+  unsigned long long LatencyHistogram::percentile(double percent) const {
+    if (percent < 0.0 || percent > 100.0) {
+      throw Exception("Percentile must be between 0 and 100");
+    }
+    // walk a snapshot of the buckets, which may be racing with record()
+    unsigned long long snapshot[BUCKETS];
+    unsigned long long total = 0;
+    for (unsigned int i = 0; i < BUCKETS; i++) {
+      snapshot[i] = counts[i].load(std::memory_order_relaxed);
+      total += snapshot[i];
+    }
+    if (total == 0) {
+      return 0;
+    }
+    // allow for e.g. 99.9 having no exact binary representation
+    unsigned long long rank = (unsigned long long)ceil(percent / 100.0 * total - 1.0e-6);
+    if (rank < 1) {
+      rank = 1;
+    }
+    unsigned long long seen = 0;
+    for (unsigned int i = 0; i < BUCKETS; i++) {
+      seen += snapshot[i];
+      if (seen >= rank) {
+        return std::min(upperBoundOf(i), getMax());
+      }
+    }
+    return getMax();
+  }
+
+  void StreamingMetrics::merge(const StreamingMetrics& other) {
+    progressiveChromagram.merge(other.progressiveChromagram);
+    finalChromagram.merge(other.finalChromagram);
+    keyOfChromagram.merge(other.keyOfChromagram);
+    hopsPerCall.merge(other.hopsPerCall);
+  }
+
+  void StreamingMetrics::clear() {
+    progressiveChromagram.clear();
+    finalChromagram.clear();
+    keyOfChromagram.clear();
+    hopsPerCall.clear();
+  }
+
+  static void writeHistogram(std::ostream& report, const char* name, const LatencyHistogram& h) {
+    report << name << " count " << h.getCount() << " mean " << h.getMean();
+    report << " p50 " << h.percentile(50.0) << " p99 " << h.percentile(99.0);
+    report << " p99.9 " << h.percentile(99.9) << " max " << h.getMax() << "\n";
+  }
+
+  // one line per histogram; latencies in nanoseconds, hops as counts
+  void StreamingMetrics::write(std::ostream& report) const {
+    writeHistogram(report, "progressiveChromagram", progressiveChromagram);
+    writeHistogram(report, "finalChromagram", finalChromagram);
+    writeHistogram(report, "keyOfChromagram", keyOfChromagram);
+    writeHistogram(report, "hopsPerCall", hopsPerCall);
+  }
+
+}
@@ -0,0 +1,74 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include "constants.h"
+#include <atomic>
+#include <ostream>
+
+namespace KeyFinder {
+
+  // Log-linear buckets in the style of HDR histograms: values below 64 are
+  // exact, and above that each power of two is split into 32 buckets, so any
+  // recorded value is reported to within about 3%. Recording is lock-free, so
+  // one histogram can be shared by several threads, or one kept per thread
+  // and merged afterwards.
+  class LatencyHistogram {
+  public:
+    LatencyHistogram();
+    void record(unsigned long long value);
+    void merge(const LatencyHistogram& other);
+    void clear();
+    unsigned long long getCount() const;
+    unsigned long long getMax() const;
+    double getMean() const;
+    unsigned long long percentile(double percent) const; // upper bound of the bucket
+    static const unsigned int BUCKETS = 64 + 58 * 32;
+  private:
+    LatencyHistogram(const LatencyHistogram&);
+    LatencyHistogram& operator=(const LatencyHistogram&);
+    void raiseMax(unsigned long long value);
+    static unsigned int bucketOf(unsigned long long value);
+    static unsigned long long upperBoundOf(unsigned int bucket);
+    std::atomic<unsigned long long> counts[BUCKETS];
+    std::atomic<unsigned long long> count;
+    std::atomic<unsigned long long> sum;
+    std::atomic<unsigned long long> max;
+  };
+
+  // Per-call latencies of the streaming interface, in nanoseconds, and the
+  // number of hops each progressiveChromagram call added to the chromagram.
+  class StreamingMetrics {
+  public:
+    LatencyHistogram progressiveChromagram;
+    LatencyHistogram finalChromagram;
+    LatencyHistogram keyOfChromagram;
+    LatencyHistogram hopsPerCall;
+    void merge(const StreamingMetrics& other);
+    void clear();
+    void write(std::ostream& report) const;
+  };
+
+}
+
+#endif
@@ -39,6 +39,7 @@ namespace KeyFinder {
     LowPassFilterPrivate(unsigned int order, unsigned int frameRate, double cornerFrequency, unsigned int fftFrameSize);
     void filter(AudioData& audio, Workspace& workspace, unsigned int shortcutFactor = 1) const;
     unsigned int order;
+    unsigned int frameRate;
     unsigned int delay;         // always order / 2
     unsigned int impulseLength; // always order + 1
     double gain;
@@ -59,11 +60,15 @@ namespace KeyFinder {
     priv->filter(audio, workspace, shortcutFactor);
   }
 
+  unsigned int LowPassFilter::getFrameRate() const {
+    return priv->frameRate;
+  }
+
   void const * LowPassFilter::getCoefficients() const {
     return &priv->coefficients;
   }
 
-  LowPassFilterPrivate::LowPassFilterPrivate(unsigned int inOrder, unsigned int frameRate, double cornerFrequency, unsigned int fftFrameSize) {
+  LowPassFilterPrivate::LowPassFilterPrivate(unsigned int inOrder, unsigned int inFrameRate, double cornerFrequency, unsigned int fftFrameSize) {
     if (inOrder % 2 != 0) {
       throw Exception("LPF order must be an even number");
     }
@@ -71,6 +76,7 @@ namespace KeyFinder {
       throw Exception("LPF order must be <= FFT frame size / 4");
     }
     order = inOrder;
+    frameRate = inFrameRate;
     delay = order / 2;
     impulseLength = order + 1;
     double cutoffPoint = cornerFrequency / frameRate;
@@ -132,12 +138,12 @@ namespace KeyFinder {
     std::vector<double>::iterator bufferBack;
     std::vector<double>::iterator bufferTemp;
 
-    unsigned int sampleCount = audio.getSampleCount();
+    size_t sampleCount = audio.getSampleCount();
     audio.resetIterators();
 
     double sum;
     // for each frame (running off the end of the sample stream by delay)
-    for (unsigned int inSample = 0; inSample < sampleCount + delay; inSample++) {
+    for (size_t inSample = 0; inSample < sampleCount + delay; inSample++) {
       // shuffle old samples along delay buffer
       bufferBack = bufferFront;
       std::advance(bufferFront, 1);
@@ -153,10 +159,10 @@ namespace KeyFinder {
         *bufferBack = 0.0; // zero pad once we're past the end of the file
       }
       // start doing the maths once the delay has passed
-      int outSample = (signed)inSample - (signed)delay;
-      if (outSample < 0) {
+      if (inSample < delay) {
         continue;
       }
+      size_t outSample = inSample - delay;
       // and, if shortcut != 1, only do the maths for the useful samples (this is mathematically dodgy, but it's faster and it usually works)
       if (outSample % shortcutFactor > 0) {
         continue;
@@ -35,6 +35,7 @@ namespace KeyFinder {
     LowPassFilter(unsigned int order, unsigned int frameRate, double cornerFrequency, unsigned int fftFrameSize);
     ~LowPassFilter();
     void filter(AudioData& audio, Workspace& workspace, unsigned int shortcutFactor = 1) const;
+    unsigned int getFrameRate() const;
     void const * getCoefficients() const; // for unit testing only
   protected:
     LowPassFilterPrivate* priv;
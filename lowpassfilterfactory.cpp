@@ -23,62 +23,10 @@
 
 namespace KeyFinder {
 
-  LowPassFilterFactory::LowPassFilterWrapper::LowPassFilterWrapper(unsigned int inOrder, unsigned int inFrameRate, double inCornerFrequency, unsigned int inFftFrameSize, const LowPassFilter* const inLowPassFilter) {
-    order = inOrder;
-    frameRate = inFrameRate;
-    cornerFrequency = inCornerFrequency;
-    fftFrameSize = inFftFrameSize;
-    lowPassFilter = inLowPassFilter;
-  }
-
-  LowPassFilterFactory::LowPassFilterWrapper::~LowPassFilterWrapper() {
-    delete lowPassFilter;
-  }
-
-  const LowPassFilter* LowPassFilterFactory::LowPassFilterWrapper::getLowPassFilter() const {
-    return lowPassFilter;
-  }
-
-  unsigned int LowPassFilterFactory::LowPassFilterWrapper::getOrder() const {
-    return order;
-  }
-
-  unsigned int LowPassFilterFactory::LowPassFilterWrapper::getFrameRate() const {
-    return frameRate;
-  }
-
-  double LowPassFilterFactory::LowPassFilterWrapper::getCornerFrequency() const {
-    return cornerFrequency;
-  }
-
-  unsigned int LowPassFilterFactory::LowPassFilterWrapper::getFftFrameSize() const {
-    return fftFrameSize;
-  }
-
-  LowPassFilterFactory::LowPassFilterFactory() : lowPassFilters(0) { }
-
-  LowPassFilterFactory::~LowPassFilterFactory() {
-    for (unsigned int i = 0; i < lowPassFilters.size(); i++) {
-      delete lowPassFilters[i];
-    }
-  }
+  LowPassFilterFactory::LowPassFilterFactory(PlanRegistry* inRegistry) : registry(inRegistry != NULL ? inRegistry : &PlanRegistry::shared()) { }
 
-  const LowPassFilter* LowPassFilterFactory::getLowPassFilter(unsigned int inOrder, unsigned int inFrameRate, double inCornerFrequency, unsigned int inFftFrameSize) {
-    for (unsigned int i = 0; i < lowPassFilters.size(); i++) {
-      LowPassFilterWrapper* wrapper = lowPassFilters[i];
-      if (wrapper->getOrder() == inOrder &&
-          wrapper->getFrameRate() == inFrameRate &&
-          wrapper->getCornerFrequency() == inCornerFrequency &&
-          wrapper->getFftFrameSize() == inFftFrameSize) {
-        return wrapper->getLowPassFilter();
-      }
-    }
-    lowPassFilterFactoryMutex.lock();
-    LowPassFilter *lpf = new LowPassFilter(inOrder, inFrameRate, inCornerFrequency, inFftFrameSize);
-    lowPassFilters.push_back(new LowPassFilterWrapper(inOrder, inFrameRate, inCornerFrequency, inFftFrameSize, lpf));
-    unsigned int newLowPassFilterIndex = lowPassFilters.size()-1;
-    lowPassFilterFactoryMutex.unlock();
-    return lowPassFilters[newLowPassFilterIndex]->getLowPassFilter();
+  std::shared_ptr<const LowPassFilter> LowPassFilterFactory::getLowPassFilter(unsigned int inOrder, unsigned int inFrameRate, double inCornerFrequency, unsigned int inFftFrameSize) {
+    return registry->getLowPassFilter(inOrder, inFrameRate, inCornerFrequency, inFftFrameSize);
   }
 
 }
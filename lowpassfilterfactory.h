@@ -24,35 +24,16 @@
 
 #include "constants.h"
 #include "lowpassfilter.h"
+#include "planregistry.h"
 
 namespace KeyFinder {
 
   class LowPassFilterFactory {
   public:
-    LowPassFilterFactory();
-    ~LowPassFilterFactory();
-    const LowPassFilter* getLowPassFilter(unsigned int order, unsigned int frameRate, double cornerFrequency, unsigned int fftFrameSize);
+    LowPassFilterFactory(PlanRegistry* registry = NULL); // NULL for the process-wide registry
+    std::shared_ptr<const LowPassFilter> getLowPassFilter(unsigned int order, unsigned int frameRate, double cornerFrequency, unsigned int fftFrameSize);
   private:
-    class LowPassFilterWrapper;
-    std::vector<LowPassFilterWrapper*> lowPassFilters;
-    std::mutex lowPassFilterFactoryMutex;
-  };
-
-  class LowPassFilterFactory::LowPassFilterWrapper {
-  public:
-    LowPassFilterWrapper(unsigned int order, unsigned int frameRate, double cornerFrequency, unsigned int fftFrameSize, const LowPassFilter* const filter);
-    ~LowPassFilterWrapper();
-    const LowPassFilter* getLowPassFilter() const;
-    unsigned int getOrder() const;
-    unsigned int getFrameRate() const;
-    double getCornerFrequency() const;
-    unsigned int getFftFrameSize() const;
-  private:
-    unsigned int order;
-    unsigned int frameRate;
-    double cornerFrequency;
-    unsigned int fftFrameSize;
-    const LowPassFilter* lowPassFilter;
+    PlanRegistry* registry;
   };
 
 }
@@ -0,0 +1,166 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#include "planregistry.h"
+#include "windowfunctions.h"
+
+namespace KeyFinder {
+
+  enum plan_kind_t {
+    PLAN_LOW_PASS_FILTER,
+    PLAN_CHROMA_TRANSFORM,
+    PLAN_TEMPORAL_WINDOW
+  };
+
+  PlanRegistry::PlanKey::PlanKey(unsigned int inKind, unsigned int inOrder, unsigned int inFrameRate, double inCornerFrequency, unsigned int inFrameSize) :
+    kind(inKind), order(inOrder), frameRate(inFrameRate), cornerFrequency(inCornerFrequency), frameSize(inFrameSize) { }
+
+  bool PlanRegistry::PlanKey::operator<(const PlanKey& that) const {
+    if (kind != that.kind) return kind < that.kind;
+    if (order != that.order) return order < that.order;
+    if (frameRate != that.frameRate) return frameRate < that.frameRate;
+    if (cornerFrequency != that.cornerFrequency) return cornerFrequency < that.cornerFrequency;
+    return frameSize < that.frameSize;
+  }
+
+  PlanRegistry::PlanEntry::PlanEntry(const PlanKey& inKey, std::shared_ptr<const void> inPlan, size_t inBytes) : key(inKey), plan(inPlan), bytes(inBytes) { }
+
+  PlanRegistry::PlanRegistry(size_t inMemoryCap) : entries(), index(), memoryCap(inMemoryCap), bytes(0), evictions(0) { }
+
+  PlanRegistry& PlanRegistry::shared() {
+    static PlanRegistry registry;
+    return registry;
+  }
+
+  // Plans are built without the mutex held, so that a new frame rate's
+  // kernel doesn't stall every other analysis waiting on the registry. Two
+  // threads may then build the same plan; insert() keeps whichever got there
+  // first and both return it.
+
+  std::shared_ptr<const LowPassFilter> PlanRegistry::getLowPassFilter(unsigned int order, unsigned int frameRate, double cornerFrequency, unsigned int fftFrameSize) {
+    PlanKey key(PLAN_LOW_PASS_FILTER, order, frameRate, cornerFrequency, fftFrameSize);
+    std::shared_ptr<const void> plan = lookup(key);
+    if (plan == NULL) {
+      plan = std::make_shared<const LowPassFilter>(order, frameRate, cornerFrequency, fftFrameSize);
+      // coefficients and the delay buffer each workspace allocates to match
+      plan = insert(key, plan, sizeof(LowPassFilter) + (order + 1) * sizeof(double) * 2);
+    }
+    return std::static_pointer_cast<const LowPassFilter>(plan);
+  }
+
+  std::shared_ptr<const ChromaTransform> PlanRegistry::getChromaTransform(unsigned int frameRate, unsigned int frameSize) {
+    PlanKey key(PLAN_CHROMA_TRANSFORM, 0, frameRate, 0.0, frameSize);
+    std::shared_ptr<const void> plan = lookup(key);
+    if (plan == NULL) {
+      std::shared_ptr<const ChromaTransform> ct = std::make_shared<const ChromaTransform>(frameRate, frameSize);
+      plan = insert(key, ct, sizeof(ChromaTransform) + ct->getKernelBytes());
+    }
+    return std::static_pointer_cast<const ChromaTransform>(plan);
+  }
+
+  std::shared_ptr<const std::vector<double> > PlanRegistry::getTemporalWindow(unsigned int frameSize) {
+    PlanKey key(PLAN_TEMPORAL_WINDOW, 0, 0, 0.0, frameSize);
+    std::shared_ptr<const void> plan = lookup(key);
+    if (plan == NULL) {
+      WindowFunction win;
+      std::shared_ptr< std::vector<double> > tw = std::make_shared< std::vector<double> >(frameSize);
+      std::vector<double>::iterator twIt = tw->begin();
+      for (unsigned int i = 0; i < frameSize; i++) {
+        *twIt = win.window(WINDOW_BLACKMAN, i, frameSize);
+        std::advance(twIt, 1);
+      }
+      plan = insert(key, tw, sizeof(std::vector<double>) + frameSize * sizeof(double));
+    }
+    return std::static_pointer_cast<const std::vector<double> >(plan);
+  }
+
+  void PlanRegistry::setMemoryCap(size_t inMemoryCap) {
+    std::lock_guard<std::mutex> lock(planRegistryMutex);
+    memoryCap = inMemoryCap;
+    evict();
+  }
+
+  size_t PlanRegistry::getMemoryCap() const {
+    std::lock_guard<std::mutex> lock(planRegistryMutex);
+    return memoryCap;
+  }
+
+  size_t PlanRegistry::getBytes() const {
+    std::lock_guard<std::mutex> lock(planRegistryMutex);
+    return bytes;
+  }
+
+  size_t PlanRegistry::getEntries() const {
+    std::lock_guard<std::mutex> lock(planRegistryMutex);
+    return entries.size();
+  }
+
+  unsigned long long PlanRegistry::getEvictions() const {
+    std::lock_guard<std::mutex> lock(planRegistryMutex);
+    return evictions;
+  }
+
+  std::shared_ptr<const void> PlanRegistry::lookup(const PlanKey& key) {
+    std::lock_guard<std::mutex> lock(planRegistryMutex);
+    return find(key);
+  }
+
+  std::shared_ptr<const void> PlanRegistry::insert(const PlanKey& key, std::shared_ptr<const void> plan, size_t planBytes) {
+    std::lock_guard<std::mutex> lock(planRegistryMutex);
+    std::shared_ptr<const void> existing = find(key);
+    if (existing != NULL) {
+      return existing;
+    }
+    entries.push_front(PlanEntry(key, plan, planBytes));
+    index.insert(std::make_pair(key, entries.begin()));
+    bytes += planBytes;
+    evict();
+    return plan;
+  }
+
+  // the following are called with the mutex held
+
+  std::shared_ptr<const void> PlanRegistry::find(const PlanKey& key) {
+    std::map< PlanKey, std::list<PlanEntry>::iterator >::iterator found = index.find(key);
+    if (found == index.end()) {
+      return std::shared_ptr<const void>();
+    }
+    entries.splice(entries.begin(), entries, found->second);
+    return found->second->plan;
+  }
+
+  void PlanRegistry::evict() {
+    std::list<PlanEntry>::iterator it = entries.end();
+    while (bytes > memoryCap && it != entries.begin()) {
+      --it;
+      // only the registry's own reference remains; no handle can be taken
+      // while the mutex is held, and a plan being inserted is still held by
+      // its builder
+      if (it->plan.use_count() == 1) {
+        bytes -= it->bytes;
+        index.erase(it->key);
+        it = entries.erase(it);
+        evictions++;
+      }
+    }
+  }
+
+}
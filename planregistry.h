@@ -0,0 +1,89 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#ifndef PLANREGISTRY_H
+#define PLANREGISTRY_H
+
+#include "constants.h"
+#include "chromatransform.h"
+#include "lowpassfilter.h"
+#include <list>
+#include <map>
+#include <memory>
+
+namespace KeyFinder {
+
+  // The filters, chroma kernels and temporal windows that analysis reuses
+  // for each frame rate, shared by every KeyFinder in the process. Handles
+  // are refcounted; once an entry has none outside the registry it may be
+  // evicted, least recently used first, to keep the estimated total under
+  // the memory cap. Entries in use are never evicted, so the cap can be
+  // exceeded while they are held.
+  class PlanRegistry {
+  public:
+    PlanRegistry(size_t memoryCap = 16 * 1024 * 1024);
+    static PlanRegistry& shared();
+    std::shared_ptr<const LowPassFilter> getLowPassFilter(unsigned int order, unsigned int frameRate, double cornerFrequency, unsigned int fftFrameSize);
+    std::shared_ptr<const ChromaTransform> getChromaTransform(unsigned int frameRate, unsigned int frameSize);
+    std::shared_ptr<const std::vector<double> > getTemporalWindow(unsigned int frameSize);
+    void setMemoryCap(size_t bytes);
+    size_t getMemoryCap() const;
+    size_t getBytes() const;
+    size_t getEntries() const;
+    unsigned long long getEvictions() const;
+  private:
+    class PlanKey;
+    class PlanEntry;
+    std::shared_ptr<const void> lookup(const PlanKey& key);
+    std::shared_ptr<const void> insert(const PlanKey& key, std::shared_ptr<const void> plan, size_t planBytes);
+    std::shared_ptr<const void> find(const PlanKey& key);
+    void evict();
+    std::list<PlanEntry> entries; // most recently used first
+    std::map< PlanKey, std::list<PlanEntry>::iterator > index;
+    size_t memoryCap;
+    size_t bytes;
+    unsigned long long evictions;
+    mutable std::mutex planRegistryMutex;
+  };
+
+  class PlanRegistry::PlanKey {
+  public:
+    PlanKey(unsigned int kind, unsigned int order, unsigned int frameRate, double cornerFrequency, unsigned int frameSize);
+    bool operator<(const PlanKey& that) const;
+  private:
+    unsigned int kind;
+    unsigned int order;
+    unsigned int frameRate;
+    double cornerFrequency;
+    unsigned int frameSize;
+  };
+
+  class PlanRegistry::PlanEntry {
+  public:
+    PlanEntry(const PlanKey& key, std::shared_ptr<const void> plan, size_t bytes);
+    PlanKey key;
+    std::shared_ptr<const void> plan;
+    size_t bytes;
+  };
+
+}
+
+#endif
@@ -0,0 +1,237 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#include "shadowevaluator.h"
+#include "keyfinder.h"
+#include "executiondomain.h"
+
+#include <chrono>
+
+namespace KeyFinder {
+
+  static const unsigned int MAX_QUEUED_SHADOW_REQUESTS = 4;
+
+  ShadowStatistics::ShadowStatistics() :
+    requests(0), evaluations(0), dropped(0), keyMismatches(0),
+    meanScoreMarginDifference(0.0), meanChromaCosineDistance(0.0), maxChromaCosineDistance(0.0),
+    primarySeconds(0.0), referenceSeconds(0.0) { }
+
+  ShadowEvaluator::ShadowEvaluator() : sampling(0), copying(0), busy(false), stopping(false), worker(NULL), reference(NULL), domain(NULL), domainChanges(0) { }
+
+  ShadowEvaluator::~ShadowEvaluator() {
+    {
+      std::lock_guard<std::mutex> lock(shadowEvaluatorMutex);
+      stopping = true;
+    }
+    queueChanged.notify_all();
+    if (worker != NULL) {
+      worker->join();
+      delete worker;
+    }
+    for (unsigned int i = 0; i < queue.size(); i++) {
+      delete queue[i];
+    }
+    if (reference != NULL) {
+      delete reference;
+    }
+  }
+
+  void ShadowEvaluator::setSampling(unsigned int oneInN) {
+    std::lock_guard<std::mutex> lock(shadowEvaluatorMutex);
+    sampling = oneInN;
+  }
+
+  void ShadowEvaluator::setExecutionDomain(ExecutionDomain* inDomain) {
+    {
+      std::lock_guard<std::mutex> lock(shadowEvaluatorMutex);
+      domain = inDomain;
+      domainChanges++;
+    }
+    queueChanged.notify_all();
+  }
+
+  bool ShadowEvaluator::sample() {
+    std::lock_guard<std::mutex> lock(shadowEvaluatorMutex);
+    if (sampling == 0) {
+      return false;
+    }
+    statistics.requests++;
+    return statistics.requests % sampling == 0;
+  }
+
+  void ShadowEvaluator::evaluate(const AudioData& audio, const std::vector<double>& primaryChromaVector, double primarySeconds) {
+    // the slot is reserved before the audio is copied, so a full queue costs
+    // nothing and the copy doesn't hold up the worker or other callers
+    {
+      std::lock_guard<std::mutex> lock(shadowEvaluatorMutex);
+      if (queue.size() + copying >= MAX_QUEUED_SHADOW_REQUESTS) {
+        statistics.dropped++;
+        return;
+      }
+      copying++;
+    }
+    ShadowRequest* request = new ShadowRequest();
+    try {
+      request->audio = audio;
+      request->primaryChromaVector = primaryChromaVector;
+    } catch (...) {
+      delete request;
+      std::lock_guard<std::mutex> lock(shadowEvaluatorMutex);
+      copying--;
+      statistics.dropped++;
+      queueChanged.notify_all();
+      throw;
+    }
+    request->primarySeconds = primarySeconds;
+    std::lock_guard<std::mutex> lock(shadowEvaluatorMutex);
+    copying--;
+    queue.push_back(request);
+    if (worker == NULL) {
+      worker = new std::thread(&ShadowEvaluator::run, this);
+    }
+    queueChanged.notify_all();
+  }
+
+  void ShadowEvaluator::wait() {
+    std::unique_lock<std::mutex> lock(shadowEvaluatorMutex);
+    while (!queue.empty() || copying > 0 || busy) {
+      queueChanged.wait(lock);
+    }
+  }
+
+  ShadowStatistics ShadowEvaluator::getStatistics() const {
+    std::lock_guard<std::mutex> lock(shadowEvaluatorMutex);
+    return statistics;
+  }
+
+  void ShadowEvaluator::run() {
+    // counts changes rather than comparing pointers, since a new domain may
+    // be allocated where a destroyed one was
+    unsigned int boundChanges = 0;
+    bool bound = false;
+    std::unique_lock<std::mutex> lock(shadowEvaluatorMutex);
+    while (true) {
+      while (queue.empty() && domainChanges == boundChanges && !stopping) {
+        queueChanged.wait(lock);
+      }
+      if (stopping) {
+        return;
+      }
+      // the worker is long-lived, so it joins the domain rather than
+      // occupying one of the domain's own threads. Binding reads the domain,
+      // so it happens under the mutex: once setExecutionDomain has replaced
+      // a domain, nothing here touches it again.
+      if (domainChanges != boundChanges) {
+        if (bound) {
+          ExecutionDomain::unbindCurrentThread();
+        }
+        if (domain != NULL) {
+          domain->bindCurrentThread();
+        }
+        bound = (domain != NULL);
+        boundChanges = domainChanges;
+      }
+      if (queue.empty()) {
+        continue;
+      }
+      ShadowRequest* request = queue.front();
+      queue.pop_front();
+      busy = true;
+      lock.unlock();
+      try {
+        compare(*request);
+      } catch (const std::exception&) {
+        std::lock_guard<std::mutex> failed(shadowEvaluatorMutex);
+        statistics.dropped++;
+      }
+      delete request;
+      lock.lock();
+      busy = false;
+      queueChanged.notify_all();
+    }
+  }
+
+  static double scoreMargin(const std::vector<double>& scores) {
+    double best = scores[SILENCE];
+    double runnerUp = 0.0;
+    for (unsigned int i = 0; i < KEYS; i++) {
+      if (scores[i] > best) {
+        runnerUp = best;
+        best = scores[i];
+      } else if (scores[i] > runnerUp) {
+        runnerUp = scores[i];
+      }
+    }
+    return best - runnerUp;
+  }
+
+  static double cosineDistance(const std::vector<double>& a, const std::vector<double>& b) {
+    double intersection = 0.0;
+    double aNorm = 0.0;
+    double bNorm = 0.0;
+    for (unsigned int i = 0; i < BANDS; i++) {
+      intersection += a[i] * b[i];
+      aNorm += a[i] * a[i];
+      bNorm += b[i] * b[i];
+    }
+    if (aNorm > 0 && bNorm > 0) {
+      return 1.0 - intersection / (sqrt(aNorm) * sqrt(bNorm));
+    }
+    return (aNorm == bNorm) ? 0.0 : 1.0;
+  }
+
+  void ShadowEvaluator::compare(const ShadowRequest& request) {
+
+    // the reference is only ever touched from the worker thread
+    if (reference == NULL) {
+      reference = new KeyFinder();
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    Workspace workspace;
+    reference->progressiveChromagram(request.audio, workspace);
+    reference->finalChromagram(workspace);
+    std::vector<double> referenceChromaVector = workspace.chromagram->collapseToOneHop();
+    std::chrono::duration<double> referenceSeconds = std::chrono::steady_clock::now() - start;
+
+    KeyClassifier classifier(toneProfileMajor(), toneProfileMinor());
+    std::vector<double> primaryScores = classifier.scores(request.primaryChromaVector);
+    std::vector<double> referenceScores = classifier.scores(referenceChromaVector);
+    key_t primaryKey = classifier.classify(request.primaryChromaVector);
+    key_t referenceKey = classifier.classify(referenceChromaVector);
+
+    double marginDifference = fabs(scoreMargin(primaryScores) - scoreMargin(referenceScores));
+    double distance = cosineDistance(request.primaryChromaVector, referenceChromaVector);
+
+    std::lock_guard<std::mutex> lock(shadowEvaluatorMutex);
+    ShadowStatistics& s = statistics;
+    s.evaluations++;
+    if (primaryKey != referenceKey) {
+      s.keyMismatches++;
+    }
+    s.meanScoreMarginDifference += (marginDifference - s.meanScoreMarginDifference) / s.evaluations;
+    s.meanChromaCosineDistance += (distance - s.meanChromaCosineDistance) / s.evaluations;
+    s.maxChromaCosineDistance = std::max(s.maxChromaCosineDistance, distance);
+    s.primarySeconds += request.primarySeconds;
+    s.referenceSeconds += referenceSeconds.count();
+  }
+
+}
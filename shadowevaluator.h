@@ -0,0 +1,90 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#ifndef SHADOWEVALUATOR_H
+#define SHADOWEVALUATOR_H
+
+#include "constants.h"
+#include "audiodata.h"
+#include <condition_variable>
+#include <thread>
+
+namespace KeyFinder {
+
+  class KeyFinder;
+  class ExecutionDomain;
+
+  class ShadowStatistics {
+  public:
+    ShadowStatistics();
+    unsigned int requests;
+    unsigned int evaluations;
+    unsigned int dropped;                    // sampled, but the queue was full or the reference failed
+    unsigned int keyMismatches;
+    double meanScoreMarginDifference;        // |primary - reference| of best minus runner-up score
+    double meanChromaCosineDistance;
+    double maxChromaCosineDistance;
+    double primarySeconds;                   // of the evaluated requests only
+    double referenceSeconds;
+  };
+
+  // Runs sampled requests through a separate reference KeyFinder on a
+  // background thread, and accumulates how far the primary results diverge.
+  class ShadowEvaluator {
+  public:
+    ShadowEvaluator();
+    ~ShadowEvaluator();
+    void setSampling(unsigned int oneInN); // 0 disables
+    // the worker binds to the domain before its next request, or unbinds if
+    // it's NULL; a domain may be destroyed once it has been replaced here
+    void setExecutionDomain(ExecutionDomain* domain);
+    bool sample();
+    void evaluate(const AudioData& audio, const std::vector<double>& primaryChromaVector, double primarySeconds);
+    void wait();
+    ShadowStatistics getStatistics() const;
+  private:
+    class ShadowRequest;
+    void run();
+    void compare(const ShadowRequest& request);
+    unsigned int sampling;
+    ShadowStatistics statistics;
+    std::deque<ShadowRequest*> queue;
+    unsigned int copying;                    // slots reserved by evaluate calls still copying their audio
+    bool busy;
+    bool stopping;
+    std::thread* worker;
+    KeyFinder* reference;
+    ExecutionDomain* domain;
+    unsigned int domainChanges;
+    mutable std::mutex shadowEvaluatorMutex;
+    std::condition_variable queueChanged;
+  };
+
+  class ShadowEvaluator::ShadowRequest {
+  public:
+    AudioData audio;
+    std::vector<double> primaryChromaVector;
+    double primarySeconds;
+  };
+
+}
+
+#endif
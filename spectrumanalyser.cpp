@@ -23,12 +23,16 @@
 
 namespace KeyFinder {
 
-  SpectrumAnalyser::SpectrumAnalyser(unsigned int frameRate, ChromaTransformFactory* spFactory, TemporalWindowFactory* twFactory) {
+  SpectrumAnalyser::SpectrumAnalyser(unsigned int inFrameRate, ChromaTransformFactory* spFactory, TemporalWindowFactory* twFactory) {
+    frameRate = inFrameRate;
     chromaTransform = spFactory->getChromaTransform(frameRate);
     tw = twFactory->getTemporalWindow(FFTFRAMESIZE);
   }
 
-  Chromagram* SpectrumAnalyser::chromagramOfWholeFrames(AudioData& audio, FftAdapter* const fftAdapter) const {
+  SpectrumAnalyser::SpectrumAnalyser(unsigned int inFrameRate, std::shared_ptr<const ChromaTransform> inChromaTransform, std::shared_ptr<const std::vector<double> > inTemporalWindow) :
+    frameRate(inFrameRate), chromaTransform(inChromaTransform), tw(inTemporalWindow) { }
+
+  Chromagram* SpectrumAnalyser::chromagramOfWholeFrames(AudioData& audio, FftAdapter* const fftAdapter, HopCache* cache, HopFeatures* features) const {
 
     if (audio.getChannels() != 1) {
       throw Exception("Audio must be monophonic to be analysed");
@@ -39,31 +43,102 @@ namespace KeyFinder {
       return new Chromagram(0);
     }
 
-    unsigned int hops = 1 + ((audio.getSampleCount() - frmSize) / HOPSIZE);
+    size_t hops = 1 + ((audio.getSampleCount() - frmSize) / HOPSIZE);
     Chromagram* ch = new Chromagram(hops);
 
-    for (unsigned int hop = 0; hop < hops; hop++) {
+    // features need the spectrum of every hop, so they bypass the cache
+    HopFeatures hopFeatures(features != NULL ? hops : 0);
+    std::vector<double> magnitudes(features != NULL ? frmSize / 2 + 1 : 0);
+
+    // each frame is hashed from the hashes of the hop-sized blocks it spans,
+    // so every sample is only hashed once
+    bool cached = cache != NULL && features == NULL && frmSize % HOPSIZE == 0;
+    unsigned int blocksPerFrame = frmSize / HOPSIZE;
+    std::vector<unsigned long long> hashes;
+    std::vector<unsigned long long> checks;
+    if (cached) {
+      blockHashes(audio, hops - 1 + blocksPerFrame, hashes, checks);
+    }
+
+    for (size_t hop = 0; hop < hops; hop++) {
+
+      unsigned long long hash = 0;
+      unsigned long long check = 0;
+      if (cached) {
+        hash = HopCache::combine(frameRate, hashes, hop, blocksPerFrame);
+        check = HopCache::combine(frameRate, checks, hop, blocksPerFrame);
+        std::vector<double> row;
+        if (cache->lookup(hash, check, row)) {
+          for (unsigned int band = 0; band < BANDS; band++) {
+            ch->setMagnitude(hop, band, row[band]);
+          }
+          continue;
+        }
+      }
 
       audio.resetIterators();
       audio.advanceReadIterator(hop * HOPSIZE);
 
       std::vector<double>::const_iterator twIt = tw->begin();
-      for (unsigned int sample = 0; sample < frmSize; sample++) {
-        fftAdapter->setInput(sample, audio.getSampleAtReadIterator() * *twIt);
-        audio.advanceReadIterator();
-        std::advance(twIt, 1);
+      if (features == NULL) {
+        for (unsigned int sample = 0; sample < frmSize; sample++) {
+          fftAdapter->setInput(sample, audio.getSampleAtReadIterator() * *twIt);
+          audio.advanceReadIterator();
+          std::advance(twIt, 1);
+        }
+      } else {
+        double sumOfSquares = 0.0;
+        double peak = 0.0;
+        for (unsigned int sample = 0; sample < frmSize; sample++) {
+          double value = audio.getSampleAtReadIterator();
+          sumOfSquares += value * value;
+          peak = std::max(peak, fabs(value));
+          fftAdapter->setInput(sample, value * *twIt);
+          audio.advanceReadIterator();
+          std::advance(twIt, 1);
+        }
+        hopFeatures.setFeature(hop, FEATURE_RMS, sqrt(sumOfSquares / frmSize));
+        hopFeatures.setFeature(hop, FEATURE_PEAK, peak);
       }
 
       fftAdapter->execute();
 
+      if (features != NULL) {
+        for (unsigned int bin = 0; bin < magnitudes.size(); bin++) {
+          magnitudes[bin] = fftAdapter->getOutputMagnitude(bin);
+        }
+        hopFeatures.setSpectralFeatures(hop, magnitudes, frameRate, frmSize);
+      }
+
       std::vector<double> cv = chromaTransform->chromaVector(fftAdapter);
       std::vector<double>::const_iterator cvIt = cv.begin();
       for (unsigned int band = 0; band < BANDS; band++) {
         ch->setMagnitude(hop, band, *cvIt);
         std::advance(cvIt, 1);
       }
+      if (cached) {
+        cache->store(hash, check, cv);
+      }
+    }
+    if (features != NULL) {
+      features->append(hopFeatures);
     }
     return ch;
   }
 
+  void SpectrumAnalyser::blockHashes(AudioData& audio, size_t blocks, std::vector<unsigned long long>& hashes, std::vector<unsigned long long>& checks) const {
+    hashes.resize(blocks);
+    checks.resize(blocks);
+    std::vector<double> block(HOPSIZE);
+    audio.resetIterators();
+    for (size_t b = 0; b < blocks; b++) {
+      for (unsigned int sample = 0; sample < HOPSIZE; sample++) {
+        block[sample] = audio.getSampleAtReadIterator();
+        audio.advanceReadIterator();
+      }
+      hashes[b] = HopCache::hashOfBlock(&block[0], HOPSIZE);
+      checks[b] = HopCache::checkOfBlock(&block[0], HOPSIZE);
+    }
+  }
+
 }
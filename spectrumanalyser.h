@@ -25,6 +25,8 @@
 #include "chromagram.h"
 #include "audiodata.h"
 #include "fftadapter.h"
+#include "hopcache.h"
+#include "hopfeatures.h"
 #include "chromatransformfactory.h"
 #include "constants.h"
 #include "temporalwindowfactory.h"
@@ -35,10 +37,13 @@ namespace KeyFinder {
   class SpectrumAnalyser {
   public:
     SpectrumAnalyser(unsigned int frameRate, ChromaTransformFactory* ctFactory, TemporalWindowFactory* twFactory);
-    Chromagram* chromagramOfWholeFrames(AudioData& audio, FftAdapter* const fft) const;
+    SpectrumAnalyser(unsigned int frameRate, std::shared_ptr<const ChromaTransform> chromaTransform, std::shared_ptr<const std::vector<double> > temporalWindow);
+    Chromagram* chromagramOfWholeFrames(AudioData& audio, FftAdapter* const fft, HopCache* cache = NULL, HopFeatures* features = NULL) const;
   protected:
-    const ChromaTransform* chromaTransform;
-    const std::vector<double>* tw;
+    void blockHashes(AudioData& audio, size_t blocks, std::vector<unsigned long long>& hashes, std::vector<unsigned long long>& checks) const;
+    unsigned int frameRate;
+    std::shared_ptr<const ChromaTransform> chromaTransform;
+    std::shared_ptr<const std::vector<double> > tw;
   };
 
 }
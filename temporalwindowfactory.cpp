@@ -23,44 +23,10 @@
 
 namespace KeyFinder {
 
-  TemporalWindowFactory::TemporalWindowWrapper::TemporalWindowWrapper(unsigned int frameSize) {
-    WindowFunction win;
-    temporalWindow.resize(frameSize);
-    std::vector<double>::iterator twIt = temporalWindow.begin();
-    for (unsigned int i = 0; i < frameSize; i++) {
-      *twIt = win.window(WINDOW_BLACKMAN, i, frameSize);
-      std::advance(twIt, 1);
-    }
-  }
-
-  unsigned int TemporalWindowFactory::TemporalWindowWrapper::getFrameSize() const {
-    return temporalWindow.size();
-  }
-
-  const std::vector<double>* TemporalWindowFactory::TemporalWindowWrapper::getTemporalWindow() const {
-    return &temporalWindow;
-  }
-
-  TemporalWindowFactory::TemporalWindowFactory() : temporalWindows(0) { }
-
-  TemporalWindowFactory::~TemporalWindowFactory() {
-    for (unsigned int i = 0; i < temporalWindows.size(); i++) {
-      delete temporalWindows[i];
-    }
-  }
+  TemporalWindowFactory::TemporalWindowFactory(PlanRegistry* inRegistry) : registry(inRegistry != NULL ? inRegistry : &PlanRegistry::shared()) { }
 
-  const std::vector<double>* TemporalWindowFactory::getTemporalWindow(unsigned int frameSize) {
-    for (unsigned int i = 0; i < temporalWindows.size(); i++) {
-      TemporalWindowWrapper* wrapper = temporalWindows[i];
-      if (wrapper->getFrameSize() == frameSize) {
-        return wrapper->getTemporalWindow();
-      }
-    }
-    temporalWindowFactoryMutex.lock();
-    temporalWindows.push_back(new TemporalWindowWrapper(frameSize));
-    unsigned int newTemporalWindowIndex = temporalWindows.size()-1;
-    temporalWindowFactoryMutex.unlock();
-    return temporalWindows[newTemporalWindowIndex]->getTemporalWindow();
+  std::shared_ptr<const std::vector<double> > TemporalWindowFactory::getTemporalWindow(unsigned int frameSize) {
+    return registry->getTemporalWindow(frameSize);
   }
 
 }
@@ -23,33 +23,19 @@
 #define TEMPORALWINDOWFACTORY_H
 
 #include "constants.h"
+#include "planregistry.h"
 #include "windowfunctions.h"
 
 namespace KeyFinder {
 
   class TemporalWindowFactory {
   public:
-    TemporalWindowFactory();
-    ~TemporalWindowFactory();
-    const std::vector<double>* getTemporalWindow(unsigned int frameSize);
+    TemporalWindowFactory(PlanRegistry* registry = NULL); // NULL for the process-wide registry
+    std::shared_ptr<const std::vector<double> > getTemporalWindow(unsigned int frameSize);
   private:
-    class TemporalWindowWrapper;
-    std::vector<TemporalWindowWrapper*> temporalWindows;
-    std::mutex temporalWindowFactoryMutex;
+    PlanRegistry* registry;
   };
 
-  class TemporalWindowFactory::TemporalWindowWrapper {
-  public:
-    TemporalWindowWrapper(unsigned int frameSize);
-    unsigned int getFrameSize() const;
-    const std::vector<double>* getTemporalWindow() const;
-  private:
-    std::vector<double> temporalWindow;
-  };
-
-
-
-
 }
 
 #endif
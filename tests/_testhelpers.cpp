@@ -21,6 +21,8 @@
 
 #include "_testhelpers.h"
 
+#include <random>
+
 float sine_wave (
   unsigned int index,
   float frequency,
@@ -29,3 +31,78 @@ float sine_wave (
 ) {
   return magnitude * sin(index * frequency / sampleRate * 2.0 * PI);
 }
+
+std::vector<float> triad (
+  float root,
+  bool minor
+) {
+  std::vector<float> frequencies;
+  frequencies.push_back(root);
+  frequencies.push_back(root * pow(2.0, (minor ? 3 : 4) / 12.0));
+  frequencies.push_back(root * pow(2.0, 7 / 12.0));
+  return frequencies;
+}
+
+float chord_wave (
+  unsigned int index,
+  const std::vector<float>& frequencies,
+  unsigned int sampleRate,
+  float magnitude
+) {
+  float sample = 0.0;
+  for (unsigned int f = 0; f < frequencies.size(); f++) {
+    sample += magnitude * sin(index * frequencies[f] / sampleRate * 2.0 * PI);
+  }
+  return sample;
+}
+
+KeyFinder::AudioData chord_audio (
+  const std::vector< std::vector<float> >& chords,
+  unsigned int sampleRate,
+  double secondsPerChord,
+  float magnitude,
+  double noise
+) {
+  std::mt19937 generator(1);
+  std::normal_distribution<double> floor(0.0, noise > 0.0 ? noise : 1.0);
+  unsigned int framesPerChord = (unsigned int)(sampleRate * secondsPerChord + 0.5);
+  KeyFinder::AudioData a;
+  a.setChannels(1);
+  a.setFrameRate(sampleRate);
+  a.addToFrameCount(framesPerChord * chords.size());
+  for (unsigned int i = 0; i < a.getFrameCount(); i++) {
+    double sample = chord_wave(i, chords[i / framesPerChord], sampleRate, magnitude);
+    if (noise > 0.0) {
+      sample += floor(generator);
+    }
+    a.setSampleByFrame(i, 0, sample);
+  }
+  return a;
+}
+
+KeyFinder::AudioData chord_audio (
+  const std::vector<float>& chord,
+  unsigned int sampleRate,
+  double seconds,
+  float magnitude,
+  double noise
+) {
+  return chord_audio(std::vector< std::vector<float> >(1, chord), sampleRate, seconds, magnitude, noise);
+}
+
+KeyFinder::AudioData stereo_chord_audio (
+  const std::vector<float>& left,
+  const std::vector<float>& right,
+  unsigned int sampleRate,
+  double seconds
+) {
+  KeyFinder::AudioData a;
+  a.setChannels(2);
+  a.setFrameRate(sampleRate);
+  a.addToFrameCount((unsigned int)(sampleRate * seconds + 0.5));
+  for (unsigned int i = 0; i < a.getFrameCount(); i++) {
+    a.setSampleByFrame(i, 0, chord_wave(i, left, sampleRate));
+    a.setSampleByFrame(i, 1, chord_wave(i, right, sampleRate));
+  }
+  return a;
+}
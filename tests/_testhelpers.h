@@ -58,4 +58,45 @@ float sine_wave (
   unsigned int magnitude = 1
 );
 
+// the frequencies of a root position major or minor triad
+std::vector<float> triad (
+  float root,
+  bool minor
+);
+
+// equal sine waves at each of the frequencies, summed
+float chord_wave (
+  unsigned int index,
+  const std::vector<float>& frequencies,
+  unsigned int sampleRate,
+  float magnitude = 1
+);
+
+// mono audio of each chord in turn, each held for the same time, over an
+// optional gaussian noise floor of the given standard deviation
+KeyFinder::AudioData chord_audio (
+  const std::vector< std::vector<float> >& chords,
+  unsigned int sampleRate,
+  double secondsPerChord,
+  float magnitude = 1,
+  double noise = 0.0
+);
+
+// mono audio of a single chord
+KeyFinder::AudioData chord_audio (
+  const std::vector<float>& chord,
+  unsigned int sampleRate,
+  double seconds,
+  float magnitude = 1,
+  double noise = 0.0
+);
+
+// stereo audio with one chord on each side
+KeyFinder::AudioData stereo_chord_audio (
+  const std::vector<float>& left,
+  const std::vector<float>& right,
+  unsigned int sampleRate,
+  double seconds
+);
+
 #endif // TESTHELPERS_H
@@ -0,0 +1,99 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#include "_testhelpers.h"
+
+TEST (AnalysisDiagnosticsTest, KeyOfAudio) {
+  unsigned int frameRate = 44100;
+  KeyFinder::AudioData a;
+  a.setChannels(2);
+  a.setFrameRate(frameRate);
+  a.addToFrameCount(frameRate * 5 + 3);
+
+  KeyFinder::KeyFinder k;
+  KeyFinder::AnalysisDiagnostics d;
+  ASSERT_EQ(k.keyOfAudio(a), k.keyOfAudio(a, d));
+
+  ASSERT_EQ(frameRate, d.frameRate);
+  ASSERT_EQ(2, d.channels);
+  ASSERT_EQ(frameRate * 5 + 3, d.frames);
+  ASSERT_EQ(1, d.calls);
+  ASSERT_EQ(10, d.downsampleFactor);
+  ASSERT_EQ(161, d.filterTaps);
+  ASSERT_TRUE(d.filterShortcut);
+  ASSERT_FALSE(d.fftEngine.empty());
+  // 22050 samples after downsampling, padded out to 6 hops
+  ASSERT_EQ(3, d.maxRemainderSamples);
+  ASSERT_EQ(6, d.hops);
+  ASSERT_EQ(16384 + 5 * 4096 - 22050, d.paddingSamples);
+  ASSERT_EQ(0, d.cachedHops);
+  ASSERT_GT(d.stageSeconds[KeyFinder::STAGE_LOWPASS], 0.0);
+  ASSERT_GT(d.stageSeconds[KeyFinder::STAGE_SPECTRUM], 0.0);
+  ASSERT_GT(d.getTotalSeconds(), 0.0);
+  ASSERT_FALSE(d.costDrivers().empty());
+
+  std::ostringstream report;
+  d.write(report);
+  ASSERT_TRUE(report.str().find("downsampleFactor: 10\n") != std::string::npos);
+  ASSERT_TRUE(report.str().find("seconds.lowpass: ") != std::string::npos);
+  ASSERT_TRUE(report.str().find("costDrivers: ") != std::string::npos);
+}
+
+TEST (AnalysisDiagnosticsTest, Streaming) {
+  KeyFinder::AudioData a;
+  a.setChannels(1);
+  a.setFrameRate(44100);
+  a.addToFrameCount(256);
+
+  KeyFinder::KeyFinder k;
+  KeyFinder::Workspace w;
+  KeyFinder::AnalysisDiagnostics d;
+  w.diagnostics = &d;
+  for (unsigned int i = 0; i < 100; i++) {
+    k.progressiveChromagram(a, w);
+  }
+  k.finalChromagram(w);
+  k.keyOfChromagram(w);
+
+  ASSERT_EQ(100, d.calls);
+  ASSERT_EQ(25600, d.frames);
+  ASSERT_LT(d.maxRemainderSamples, d.downsampleFactor);
+  // 2560 samples at most while streaming, then padded to a whole frame
+  ASSERT_EQ(16384, d.peakBufferedSamples);
+  ASSERT_GT(d.stageSeconds[KeyFinder::STAGE_CLASSIFY], 0.0);
+  ASSERT_TRUE(d.costDrivers().find("small packets (100 calls of 256 frames)") != std::string::npos);
+  ASSERT_TRUE(d.costDrivers().find("short input") != std::string::npos);
+}
+
+TEST (AnalysisDiagnosticsTest, CostDrivers) {
+  KeyFinder::AnalysisDiagnostics d;
+  ASSERT_EQ("", d.costDrivers());
+  d.frameRate = 192000;
+  d.downsampleFactor = 43;
+  d.filterTaps = 161;
+  d.channels = 6;
+  d.hops = 10000;
+  d.stageSeconds[KeyFinder::STAGE_LOWPASS] = 3.0;
+  d.stageSeconds[KeyFinder::STAGE_SPECTRUM] = 1.0;
+  ASSERT_EQ("lowpass took 75% of 4s; high input rate (192000Hz through a 161-tap filter); 6 channels mixed to mono; long input (10000 hops)", d.costDrivers());
+  ASSERT_EQ(std::string("spectrum"), KeyFinder::AnalysisDiagnostics::stageName(KeyFinder::STAGE_SPECTRUM));
+  ASSERT_THROW(KeyFinder::AnalysisDiagnostics::stageName(KeyFinder::STAGES), KeyFinder::Exception);
+}
@@ -0,0 +1,173 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#include "_testhelpers.h"
+
+#include <cstring>
+
+TEST (ArrowExportTest, ChromagramIsHandedOverWithoutACopy) {
+  KeyFinder::Chromagram c(3);
+  for (unsigned int h = 0; h < 3; h++) {
+    for (unsigned int b = 0; b < BANDS; b++) {
+      c.setMagnitude(h, b, h * 100 + b);
+    }
+  }
+  ArrowArray array;
+  ArrowSchema schema;
+  KeyFinder::exportChromagram(c, &array, &schema);
+  ASSERT_EQ(0, c.getHops());
+
+  ASSERT_EQ(std::string("+w:72"), schema.format);
+  ASSERT_EQ(std::string("chromagram"), schema.name);
+  ASSERT_EQ(1, schema.n_children);
+  ASSERT_EQ(std::string("g"), schema.children[0]->format);
+
+  ASSERT_EQ(3, array.length);
+  ASSERT_EQ(0, array.null_count);
+  ASSERT_EQ(1, array.n_buffers);
+  ASSERT_TRUE(array.buffers[0] == NULL);
+  ASSERT_EQ(1, array.n_children);
+  ArrowArray* values = array.children[0];
+  ASSERT_EQ(3 * BANDS, values->length);
+  ASSERT_EQ(2, values->n_buffers);
+  const double* data = (const double*)values->buffers[1];
+  for (unsigned int h = 0; h < 3; h++) {
+    for (unsigned int b = 0; b < BANDS; b++) {
+      ASSERT_FLOAT_EQ(h * 100 + b, data[h * BANDS + b]);
+    }
+  }
+
+  array.release(&array);
+  schema.release(&schema);
+  ASSERT_TRUE(array.release == NULL);
+  ASSERT_TRUE(schema.release == NULL);
+}
+
+TEST (ArrowExportTest, HopScoresMatchTheClassifier) {
+  KeyFinder::Chromagram c(2);
+  for (unsigned int b = 0; b < BANDS; b++) {
+    unsigned int pitchClass = b % SEMITONES;
+    c.setMagnitude(0, b, (pitchClass == 0 || pitchClass == 3 || pitchClass == 7) ? 1.0 : 0.0);
+    c.setMagnitude(1, b, (pitchClass == 3 || pitchClass == 7 || pitchClass == 10) ? 1.0 : 0.0);
+  }
+  KeyFinder::KeyClassifier classifier(KeyFinder::toneProfileMajor(), KeyFinder::toneProfileMinor());
+
+  ArrowArray array;
+  ArrowSchema schema;
+  KeyFinder::exportHopScores(c, classifier, &array, &schema);
+  ASSERT_EQ(2, c.getHops());
+  ASSERT_EQ(std::string("+w:25"), schema.format);
+  ASSERT_EQ(2, array.length);
+  const double* data = (const double*)array.children[0]->buffers[1];
+  for (unsigned int h = 0; h < 2; h++) {
+    std::vector<double> hop(BANDS);
+    for (unsigned int b = 0; b < BANDS; b++) {
+      hop[b] = c.getMagnitude(h, b);
+    }
+    std::vector<double> scores = classifier.scores(hop);
+    for (unsigned int k = 0; k < KEYS + 1; k++) {
+      ASSERT_FLOAT_EQ(scores[k], data[h * (KEYS + 1) + k]);
+    }
+  }
+  array.release(&array);
+  schema.release(&schema);
+}
+
+TEST (ArrowExportTest, BatchResults) {
+  std::vector<KeyFinder::BatchResult> results(3);
+  results[0].path = "a.wav";
+  results[0].key = KeyFinder::A_MINOR;
+  results[0].chromaVector = std::vector<double>(BANDS, 0.5);
+  results[1].path = "speech.wav";
+  results[1].key = KeyFinder::SILENCE;
+  results[2].path = "";
+  results[2].key = KeyFinder::C_MAJOR;
+  results[2].chromaVector = std::vector<double>(BANDS, 0.25);
+
+  ArrowArray array;
+  ArrowSchema schema;
+  KeyFinder::exportBatchResults(results, &array, &schema);
+
+  ASSERT_EQ(std::string("+s"), schema.format);
+  ASSERT_EQ(3, schema.n_children);
+  ASSERT_EQ(std::string("path"), schema.children[0]->name);
+  ASSERT_EQ(std::string("u"), schema.children[0]->format);
+  ASSERT_EQ(std::string("key"), schema.children[1]->name);
+  ASSERT_EQ(std::string("i"), schema.children[1]->format);
+  ASSERT_EQ(std::string("chroma"), schema.children[2]->name);
+  ASSERT_EQ(ARROW_FLAG_NULLABLE, schema.children[2]->flags);
+  ASSERT_EQ(3, array.length);
+  ASSERT_EQ(3, array.n_children);
+
+  ArrowArray* paths = array.children[0];
+  ASSERT_EQ(3, paths->n_buffers);
+  const int32_t* offsets = (const int32_t*)paths->buffers[1];
+  const char* characters = (const char*)paths->buffers[2];
+  ASSERT_EQ(0, offsets[0]);
+  ASSERT_EQ(5, offsets[1]);
+  ASSERT_EQ(15, offsets[2]);
+  ASSERT_EQ(15, offsets[3]);
+  ASSERT_EQ(0, strncmp("a.wavspeech.wav", characters, 15));
+
+  const int32_t* keys = (const int32_t*)array.children[1]->buffers[1];
+  ASSERT_EQ(KeyFinder::A_MINOR, keys[0]);
+  ASSERT_EQ(KeyFinder::SILENCE, keys[1]);
+  ASSERT_EQ(KeyFinder::C_MAJOR, keys[2]);
+
+  ArrowArray* chroma = array.children[2];
+  ASSERT_EQ(1, chroma->null_count);
+  const uint8_t* validity = (const uint8_t*)chroma->buffers[0];
+  ASSERT_EQ(5, validity[0]);
+  ASSERT_EQ(3 * BANDS, chroma->children[0]->length);
+  const double* values = (const double*)chroma->children[0]->buffers[1];
+  ASSERT_FLOAT_EQ(0.5, values[0]);
+  ASSERT_FLOAT_EQ(0.25, values[2 * BANDS + BANDS - 1]);
+
+  array.release(&array);
+  schema.release(&schema);
+  ASSERT_TRUE(array.release == NULL);
+}
+
+TEST (ArrowExportTest, EmptyExportsHaveBuffers) {
+  ArrowArray array;
+  ArrowSchema schema;
+  KeyFinder::exportBatchResults(std::vector<KeyFinder::BatchResult>(), &array, &schema);
+  ASSERT_EQ(0, array.length);
+  ASSERT_TRUE(array.children[0]->buffers[1] != NULL);
+  ASSERT_TRUE(array.children[1]->buffers[1] != NULL);
+  array.release(&array);
+  schema.release(&schema);
+
+  KeyFinder::Chromagram c;
+  KeyFinder::exportChromagram(c, &array, &schema);
+  ASSERT_EQ(0, array.length);
+  ASSERT_TRUE(array.children[0]->buffers[1] != NULL);
+  array.release(&array);
+  schema.release(&schema);
+}
+
+TEST (ArrowExportTest, RejectsMalformedChroma) {
+  std::vector<KeyFinder::BatchResult> results(1);
+  results[0].chromaVector = std::vector<double>(SEMITONES, 1.0);
+  ArrowArray array;
+  ArrowSchema schema;
+  ASSERT_THROW(KeyFinder::exportBatchResults(results, &array, &schema), KeyFinder::Exception);
+}
@@ -249,6 +249,64 @@ TEST_CASE ("AudioDataTest/SliceFromBack") {
   delete b;
 }
 
+TEST_CASE ("AudioDataTest/CopyFrames") {
+  KeyFinder::AudioData a;
+  a.setChannels(2);
+  a.setFrameRate(1);
+  a.addToFrameCount(10);
+
+  for (unsigned int i = 0; i < a.getSampleCount(); i++) {
+    a.setSample(i, i);
+  }
+
+  KeyFinder::AudioData* b = NULL;
+  KeyFinder::AudioData* nullPtr = NULL;
+
+  ASSERT_THROW(b = a.copyFrames(8, 3), KeyFinder::Exception);
+  ASSERT_EQ(nullPtr, b);
+  // a range whose end wraps around must not pass the bounds check
+  ASSERT_THROW(b = a.copyFrames(3, (size_t)-1), KeyFinder::Exception);
+  ASSERT_EQ(nullPtr, b);
+
+  ASSERT_NO_THROW(b = a.copyFrames(3, 4));
+  ASSERT_NE(nullPtr, b);
+  ASSERT_EQ(20, a.getSampleCount());
+  ASSERT_EQ(2, b->getChannels());
+  ASSERT_EQ(1, b->getFrameRate());
+  ASSERT_EQ(4, b->getFrameCount());
+  ASSERT_FLOAT_EQ(6.0, b->getSample(0));
+  ASSERT_FLOAT_EQ(13.0, b->getSample(7));
+  delete b;
+}
+
+TEST_CASE ("AudioDataTest/MixToMono") {
+  KeyFinder::AudioData a;
+  a.setChannels(2);
+  a.setFrameRate(1);
+  a.addToFrameCount(3);
+  for (unsigned int i = 0; i < a.getSampleCount(); i++) {
+    a.setSample(i, i);
+  }
+
+  std::vector<double> side(2);
+  side[0] = 0.5;
+  side[1] = -0.5;
+  KeyFinder::AudioData* b = NULL;
+  KeyFinder::AudioData* nullPtr = NULL;
+  ASSERT_THROW(b = a.mixToMono(std::vector<double>(3, 1.0)), KeyFinder::Exception);
+  ASSERT_EQ(nullPtr, b);
+
+  ASSERT_NO_THROW(b = a.mixToMono(side));
+  ASSERT_EQ(2, a.getChannels());
+  ASSERT_EQ(1, b->getChannels());
+  ASSERT_EQ(1, b->getFrameRate());
+  ASSERT_EQ(3, b->getSampleCount());
+  for (unsigned int i = 0; i < 3; i++) {
+    ASSERT_FLOAT_EQ(-0.5, b->getSample(i));
+  }
+  delete b;
+}
+
 TEST_CASE ("AudioDataTest/MakeMono") {
   KeyFinder::AudioData a;
   a.setChannels(2);
@@ -0,0 +1,162 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#include "_testhelpers.h"
+#include <cstdio>
+#include <fstream>
+
+static KeyFinder::BatchResult batch_result(const std::string& path, KeyFinder::key_t key, unsigned int chroma = 0) {
+  KeyFinder::BatchResult r;
+  r.path = path;
+  r.key = key;
+  for (unsigned int i = 0; i < chroma; i++) {
+    r.chromaVector.push_back(i / 3.0);
+  }
+  return r;
+}
+
+TEST (BatchJournalTest, ShardSpecParsing) {
+  KeyFinder::ShardSpec s("2/5");
+  ASSERT_EQ(2, s.getIndex());
+  ASSERT_EQ(5, s.getCount());
+  ASSERT_THROW(KeyFinder::ShardSpec("5/5"), KeyFinder::Exception);
+  ASSERT_THROW(KeyFinder::ShardSpec("-1/5"), KeyFinder::Exception);
+  ASSERT_THROW(KeyFinder::ShardSpec("1/0"), KeyFinder::Exception);
+  ASSERT_THROW(KeyFinder::ShardSpec("1-2"), KeyFinder::Exception);
+  ASSERT_THROW(KeyFinder::ShardSpec("1/2x"), KeyFinder::Exception);
+  ASSERT_THROW(KeyFinder::ShardSpec(3, 3), KeyFinder::Exception);
+}
+
+TEST (BatchJournalTest, ShardsPartitionPaths) {
+  std::vector<KeyFinder::ShardSpec> shards;
+  for (unsigned int i = 0; i < 4; i++) {
+    shards.push_back(KeyFinder::ShardSpec(i, 4));
+  }
+  std::vector<unsigned int> counts(4, 0);
+  for (unsigned int p = 0; p < 1000; p++) {
+    std::ostringstream path;
+    path << "/music/album " << p / 10 << "/track " << p % 10 << ".wav";
+    unsigned int matches = 0;
+    for (unsigned int i = 0; i < 4; i++) {
+      if (shards[i].includes(path.str())) {
+        matches++;
+        counts[i]++;
+      }
+    }
+    ASSERT_EQ(1, matches);
+  }
+  for (unsigned int i = 0; i < 4; i++) {
+    ASSERT_GT(counts[i], 200);
+  }
+  // stable across builds and machines
+  ASSERT_EQ(0xcbf29ce484222325ULL, KeyFinder::ShardSpec::pathHash(""));
+  ASSERT_EQ(0xaf63dc4c8601ec8cULL, KeyFinder::ShardSpec::pathHash("a"));
+}
+
+TEST (BatchJournalTest, JournalResumes) {
+  std::string filename = "batchjournaltest_resume.journal";
+  std::remove(filename.c_str());
+  {
+    KeyFinder::BatchJournal j(filename);
+    ASSERT_FALSE(j.contains("a.wav"));
+    j.append(batch_result("a.wav", KeyFinder::A_MINOR, BANDS));
+    j.append(batch_result("tab\tnewline\nback\\slash.wav", KeyFinder::SILENCE));
+    ASSERT_TRUE(j.contains("a.wav"));
+  }
+  {
+    KeyFinder::BatchJournal j(filename);
+    ASSERT_TRUE(j.contains("a.wav"));
+    ASSERT_TRUE(j.contains("tab\tnewline\nback\\slash.wav"));
+    ASSERT_FALSE(j.contains("b.wav"));
+    std::vector<KeyFinder::BatchResult> results = j.getResults();
+    ASSERT_EQ(2, results.size());
+    ASSERT_EQ(KeyFinder::A_MINOR, results[0].key);
+    ASSERT_EQ(BANDS, results[0].chromaVector.size());
+    ASSERT_FLOAT_EQ(71 / 3.0, results[0].chromaVector[71]);
+    ASSERT_EQ(0, results[1].chromaVector.size());
+  }
+  std::remove(filename.c_str());
+}
+
+TEST (BatchJournalTest, JournalSkipsTornRecords) {
+  std::string filename = "batchjournaltest_torn.journal";
+  std::remove(filename.c_str());
+  {
+    KeyFinder::BatchJournal j(filename);
+    j.append(batch_result("a.wav", KeyFinder::A_MINOR));
+  }
+  {
+    // a crash part way through a record, and a corrupted record
+    std::ofstream f(filename.c_str(), std::ios::app | std::ios::binary);
+    f << "5\t0\t\tcorrupt.wav\tdeadbeef\n";
+    f << "7\t0\t\tto";
+  }
+  {
+    KeyFinder::BatchJournal j(filename);
+    ASSERT_EQ(1, j.getResults().size());
+    j.append(batch_result("b.wav", KeyFinder::B_MINOR));
+  }
+  std::vector<KeyFinder::BatchResult> results = KeyFinder::BatchJournal::read(filename);
+  ASSERT_EQ(2, results.size());
+  ASSERT_EQ("a.wav", results[0].path);
+  ASSERT_EQ("b.wav", results[1].path);
+  std::remove(filename.c_str());
+}
+
+TEST (BatchJournalTest, MergeCombinesShards) {
+  std::vector<std::string> filenames;
+  filenames.push_back("batchjournaltest_merge0.journal");
+  filenames.push_back("batchjournaltest_merge1.journal");
+  for (unsigned int i = 0; i < filenames.size(); i++) {
+    std::remove(filenames[i].c_str());
+  }
+  {
+    KeyFinder::BatchJournal j0(filenames[0]);
+    KeyFinder::BatchJournal j1(filenames[1]);
+    j0.append(batch_result("c.wav", KeyFinder::C_MAJOR));
+    j1.append(batch_result("a.wav", KeyFinder::A_MAJOR));
+    j0.append(batch_result("b.wav", KeyFinder::B_MAJOR));
+    j1.append(batch_result("c.wav", KeyFinder::C_MINOR));
+  }
+  std::vector<KeyFinder::BatchResult> merged = KeyFinder::BatchJournal::merge(filenames);
+  ASSERT_EQ(3, merged.size());
+  ASSERT_EQ("a.wav", merged[0].path);
+  ASSERT_EQ("b.wav", merged[1].path);
+  ASSERT_EQ("c.wav", merged[2].path);
+  ASSERT_EQ(KeyFinder::C_MINOR, merged[2].key);
+  for (unsigned int i = 0; i < filenames.size(); i++) {
+    std::remove(filenames[i].c_str());
+  }
+}
+
+TEST (BatchJournalTest, MergeRejectsMissingShards) {
+  std::vector<std::string> filenames;
+  filenames.push_back("batchjournaltest_present.journal");
+  filenames.push_back("batchjournaltest_missing.journal");
+  std::remove(filenames[1].c_str());
+  {
+    KeyFinder::BatchJournal j(filenames[0]);
+    j.append(batch_result("a.wav", KeyFinder::A_MAJOR));
+  }
+  ASSERT_THROW(KeyFinder::BatchJournal::read(filenames[1]), KeyFinder::Exception);
+  ASSERT_THROW(KeyFinder::BatchJournal::merge(filenames), KeyFinder::Exception);
+  std::remove(filenames[0].c_str());
+}
@@ -0,0 +1,125 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#include "_testhelpers.h"
+
+// a minute of triads at the analysis rate, changing every two seconds
+static KeyFinder::AudioData chordSequence(const unsigned int* roots, double gain, double noise) {
+  unsigned int frameRate = 4410;
+  unsigned int seconds = 60;
+  KeyFinder::AudioData a;
+  a.setChannels(1);
+  a.setFrameRate(frameRate);
+  a.addToSampleCount(frameRate * seconds);
+  unsigned int seed = 12345;
+  for (unsigned int i = 0; i < frameRate * seconds; i++) {
+    unsigned int root = roots[i / (frameRate * 2) % 8];
+    double sample = chord_wave(i, triad(220.0 * pow(2.0, root / 12.0), false), frameRate);
+    seed = seed * 1103515245 + 12345;
+    sample = sample * gain + noise * ((seed >> 16) / 32768.0 - 1.0);
+    a.setSample(i, sample);
+  }
+  return a;
+}
+
+static KeyFinder::ChromaFingerprint fingerprintOf(const KeyFinder::AudioData& a) {
+  KeyFinder::KeyFinder k;
+  KeyFinder::Workspace w;
+  KeyFinder::ChromaFingerprint f;
+  w.fingerprint = &f;
+  k.progressiveChromagramAtAnalysisRate(a, w);
+  k.finalChromagram(w);
+  return f;
+}
+
+static const unsigned int SONG[] = { 0, 5, 7, 3, 10, 2, 8, 5 };
+static const unsigned int OTHER_SONG[] = { 4, 11, 1, 6, 9, 4, 0, 7 };
+
+TEST (ChromaFingerprintTest, HammingDistance) {
+  ASSERT_EQ(0, KeyFinder::ChromaFingerprint::hammingDistance(0xDEADBEEF, 0xDEADBEEF));
+  ASSERT_EQ(32, KeyFinder::ChromaFingerprint::hammingDistance(0, 0xFFFFFFFF));
+  ASSERT_EQ(2, KeyFinder::ChromaFingerprint::hammingDistance(0x5, 0x6));
+}
+
+TEST (ChromaFingerprintTest, OneWordPerHopAfterTheFirst) {
+  KeyFinder::Chromagram c(5);
+  for (unsigned int h = 0; h < 5; h++) {
+    c.setMagnitude(h, h, 1.0);
+  }
+  KeyFinder::ChromaFingerprint f;
+  f.append(c);
+  ASSERT_EQ(4, f.size());
+  KeyFinder::Chromagram d(2);
+  f.append(d);
+  ASSERT_EQ(6, f.size());
+}
+
+TEST (ChromaFingerprintTest, MatchesDegradedCopyOnly) {
+  KeyFinder::ChromaFingerprint song = fingerprintOf(chordSequence(SONG, 1.0, 0.0));
+  KeyFinder::ChromaFingerprint other = fingerprintOf(chordSequence(OTHER_SONG, 1.0, 0.0));
+  KeyFinder::ChromaFingerprint degraded = fingerprintOf(chordSequence(SONG, 0.4, 0.3));
+  ASSERT_GT(song.size(), 50);
+
+  KeyFinder::FingerprintIndex index;
+  index.add(1, song);
+  index.add(2, other);
+  ASSERT_EQ(2, index.getSize());
+  ASSERT_THROW(index.add(2, other), KeyFinder::Exception);
+
+  std::vector<KeyFinder::FingerprintMatch> matches = index.match(degraded);
+  ASSERT_EQ(1, matches.size());
+  ASSERT_EQ(1, matches[0].id);
+  ASSERT_EQ(0, matches[0].offset);
+  ASSERT_EQ(song.size(), matches[0].overlap);
+  ASSERT_LT(matches[0].bitErrorRate, 0.15);
+}
+
+TEST (ChromaFingerprintTest, MatchesExcerptAtItsOffset) {
+  KeyFinder::AudioData a = chordSequence(SONG, 1.0, 0.0);
+  KeyFinder::AudioData* excerpt = a.copyFrames(HOPSIZE * 10, HOPSIZE * 30);
+  KeyFinder::ChromaFingerprint song = fingerprintOf(a);
+  KeyFinder::ChromaFingerprint query = fingerprintOf(*excerpt);
+  delete excerpt;
+
+  KeyFinder::FingerprintIndex index;
+  index.add(7, song);
+  std::vector<KeyFinder::FingerprintMatch> matches = index.match(query);
+  ASSERT_EQ(1, matches.size());
+  ASSERT_EQ(7, matches[0].id);
+  ASSERT_EQ(10, matches[0].offset);
+}
+
+TEST (ChromaFingerprintTest, KeyOfAudioFillsFingerprint) {
+  KeyFinder::AudioData a;
+  a.setChannels(1);
+  a.setFrameRate(44100);
+  a.addToSampleCount(44100 * 10);
+  for (unsigned int i = 0; i < 44100 * 10; i++) {
+    a.setSample(i, sine_wave(i, 440.0, 44100, 1));
+  }
+  KeyFinder::KeyFinder k;
+  KeyFinder::ChromaFingerprint f;
+  ASSERT_EQ(k.keyOfAudio(a), k.keyOfAudio(a, f));
+  KeyFinder::Workspace w;
+  k.progressiveChromagram(a, w);
+  k.finalChromagram(w);
+  ASSERT_EQ(w.chromagram->getHops() - 1, f.size());
+}
@@ -108,3 +108,18 @@ TEST (ChromagramTest, CollapseToOneHop) {
   ASSERT_EQ(72, d.size());
   ASSERT_FLOAT_EQ(15.0, d[0]);
 }
+
+TEST (ChromagramTest, SwapData) {
+  KeyFinder::Chromagram c(2);
+  c.setMagnitude(1, 5, 3.0);
+  std::vector<double> data(3 * BANDS, 1.0);
+  ASSERT_NO_THROW(c.swapData(data));
+  ASSERT_EQ(3, c.getHops());
+  ASSERT_FLOAT_EQ(1.0, c.getMagnitude(2, 71));
+  ASSERT_EQ(2 * BANDS, data.size());
+  ASSERT_FLOAT_EQ(3.0, data[1 * BANDS + 5]);
+
+  std::vector<double> partial(BANDS + 1, 0.0);
+  ASSERT_THROW(c.swapData(partial), KeyFinder::Exception);
+  ASSERT_EQ(3, c.getHops());
+}
@@ -24,10 +24,23 @@
 TEST (ChromaTransformFactoryTest, RepeatedTransformRequests) {
   KeyFinder::ChromaTransformFactory ctf;
 
-  const KeyFinder::ChromaTransform* ct1 = ctf.getChromaTransform(4410);
-  const KeyFinder::ChromaTransform* ct2 = ctf.getChromaTransform(4410);
-  const KeyFinder::ChromaTransform* ct3 = ctf.getChromaTransform(4800);
+  std::shared_ptr<const KeyFinder::ChromaTransform> ct1 = ctf.getChromaTransform(4410);
+  std::shared_ptr<const KeyFinder::ChromaTransform> ct2 = ctf.getChromaTransform(4410);
+  std::shared_ptr<const KeyFinder::ChromaTransform> ct3 = ctf.getChromaTransform(4800);
 
   ASSERT_EQ(ct1, ct2);
   ASSERT_NE(ct2, ct3);
 }
+
+TEST (ChromaTransformFactoryTest, TransformsPerFrameSize) {
+  KeyFinder::ChromaTransformFactory ctf;
+
+  std::shared_ptr<const KeyFinder::ChromaTransform> ct1 = ctf.getChromaTransform(4410);
+  std::shared_ptr<const KeyFinder::ChromaTransform> ct2 = ctf.getChromaTransform(4410, FFTFRAMESIZE / 2);
+  std::shared_ptr<const KeyFinder::ChromaTransform> ct3 = ctf.getChromaTransform(4410, FFTFRAMESIZE / 2);
+
+  ASSERT_NE(ct1, ct2);
+  ASSERT_EQ(ct2, ct3);
+  ASSERT_EQ(FFTFRAMESIZE, ct1->getFrameSize());
+  ASSERT_EQ(FFTFRAMESIZE / 2, ct2->getFrameSize());
+}
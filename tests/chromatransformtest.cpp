@@ -94,3 +94,42 @@ public:
     ASSERT_NEAR(KeyFinder::getFrequencyOfBand(i), peakFrequency, 0.2);
   }
 }*/
+
+TEST (ChromaTransformTest, ExternalFrameSize) {
+  KeyFinder::ChromaTransform* ct = NULL;
+  // a quarter of the frame size needs a quarter of the frame rate for the same bass resolution
+  ASSERT_THROW(ct = new KeyFinder::ChromaTransform(31861 / 4 + 1, FFTFRAMESIZE / 4), KeyFinder::Exception);
+  ASSERT_NO_THROW(ct = new KeyFinder::ChromaTransform(4410, FFTFRAMESIZE / 2));
+  ASSERT_EQ(FFTFRAMESIZE / 2, ct->getFrameSize());
+  std::vector<double> tooShort(FFTFRAMESIZE / 4, 1.0);
+  ASSERT_THROW(ct->chromaVector(tooShort), KeyFinder::Exception);
+  delete ct;
+}
+
+TEST (ChromaTransformTest, MagnitudesMatchFftAdapter) {
+  unsigned int frameRate = 4410;
+  KeyFinder::FftAdapter fft(FFTFRAMESIZE);
+  for (unsigned int i = 0; i < FFTFRAMESIZE; i++) {
+    fft.setInput(i, sine_wave(i, 440.0, frameRate, 1) + sine_wave(i, 261.6256, frameRate, 1));
+  }
+  fft.execute();
+  std::vector<double> magnitudes(FFTFRAMESIZE / 2 + 1);
+  for (unsigned int i = 0; i < magnitudes.size(); i++) {
+    magnitudes[i] = fft.getOutputMagnitude(i);
+  }
+  KeyFinder::ChromaTransform ct(frameRate);
+  std::vector<double> fromFft = ct.chromaVector(&fft);
+  std::vector<double> fromMagnitudes = ct.chromaVector(magnitudes);
+  for (unsigned int band = 0; band < BANDS; band++) {
+    ASSERT_FLOAT_EQ(fromFft[band], fromMagnitudes[band]);
+  }
+}
+
+TEST (ChromaTransformTest, KernelCoefficientsMatchTheBuiltKernel) {
+  unsigned int frameRates[] = { 4410, 4800, 8000 };
+  for (unsigned int i = 0; i < 3; i++) {
+    KeyFinder::ChromaTransform ct(frameRates[i]);
+    size_t overhead = BANDS * (sizeof(std::vector<double>) + sizeof(unsigned int));
+    ASSERT_EQ(ct.getKernelBytes() - overhead, KeyFinder::ChromaTransform::getKernelCoefficients(frameRates[i]) * sizeof(double));
+  }
+}
@@ -0,0 +1,93 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#include "_testhelpers.h"
+
+static unsigned int hopsOfAnalysis(unsigned int frames, unsigned int channels, unsigned int frameRate) {
+  KeyFinder::AudioData a;
+  a.setChannels(channels);
+  a.setFrameRate(frameRate);
+  a.addToFrameCount(frames);
+  KeyFinder::KeyFinder k;
+  KeyFinder::Workspace w;
+  k.progressiveChromagram(a, w);
+  k.finalChromagram(w);
+  return w.chromagram->getHops();
+}
+
+TEST (CostEstimatorTest, HopCountMatchesAnalysis) {
+  KeyFinder::KeyFinder k;
+  ASSERT_EQ(hopsOfAnalysis(44100, 1, 44100), k.estimateCost(44100, 1, 44100).hops);
+  ASSERT_EQ(hopsOfAnalysis(441004, 1, 44100), k.estimateCost(441004, 1, 44100).hops);
+  ASSERT_EQ(hopsOfAnalysis(96000, 2, 48000), k.estimateCost(96000, 2, 48000).hops);
+  ASSERT_EQ(hopsOfAnalysis(30000, 6, 96000), k.estimateCost(30000, 6, 96000).hops);
+}
+
+TEST (CostEstimatorTest, CostScalesWithInput) {
+  KeyFinder::KeyFinder k;
+  KeyFinder::CostEstimate shortMono = k.estimateCost(441000, 1, 44100);
+  KeyFinder::CostEstimate longMono = k.estimateCost(882000, 1, 44100);
+  KeyFinder::CostEstimate shortStereo = k.estimateCost(441000, 2, 44100);
+
+  ASSERT_GT(shortMono.flops, 0.0);
+  ASSERT_NEAR(2.0, longMono.flops / shortMono.flops, 0.1);
+  ASSERT_GT(shortStereo.flops, shortMono.flops);
+  ASSERT_GT(longMono.peakMemoryBytes, shortMono.peakMemoryBytes);
+  ASSERT_GT(shortStereo.peakMemoryBytes, shortMono.peakMemoryBytes);
+  ASSERT_GT(shortMono.minSeconds, 0.0);
+  ASSERT_GT(shortMono.maxSeconds, shortMono.minSeconds);
+}
+
+TEST (CostEstimatorTest, ObservationsCalibrateTimeRange) {
+  KeyFinder::CostEstimator ce;
+  ASSERT_EQ(0, ce.getObservations());
+
+  KeyFinder::CostEstimate e = ce.estimate(441000, 1, 44100, 10);
+  double seconds = e.flops * 1.0e-9;
+  for (unsigned int i = 0; i < 50; i++) {
+    ce.observe(e, seconds);
+  }
+  ASSERT_EQ(50, ce.getObservations());
+
+  KeyFinder::CostEstimate calibrated = ce.estimate(441000, 1, 44100, 10);
+  ASSERT_LE(calibrated.minSeconds, seconds);
+  ASSERT_GE(calibrated.maxSeconds, seconds);
+  ASSERT_LT(calibrated.maxSeconds - calibrated.minSeconds, seconds * 0.01);
+}
+
+TEST (CostEstimatorTest, KeyOfAudioCalibratesEstimator) {
+  KeyFinder::AudioData a;
+  a.setChannels(1);
+  a.setFrameRate(44100);
+  a.addToFrameCount(44100);
+  KeyFinder::KeyFinder k;
+  KeyFinder::CostEstimate before = k.estimateCost(44100, 1, 44100);
+  k.keyOfAudio(a);
+  KeyFinder::CostEstimate after = k.estimateCost(44100, 1, 44100);
+  ASSERT_FLOAT_EQ(before.flops, after.flops);
+  ASSERT_NE(before.maxSeconds, after.maxSeconds);
+}
+
+TEST (CostEstimatorTest, Bounds) {
+  KeyFinder::CostEstimator ce;
+  ASSERT_THROW(ce.estimate(44100, 0, 44100, 10), KeyFinder::Exception);
+  ASSERT_THROW(ce.estimate(44100, 1, 44100, 0), KeyFinder::Exception);
+}
@@ -0,0 +1,182 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#include "_testhelpers.h"
+
+#include <atomic>
+#include <stdexcept>
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+TEST (ExecutionDomainTest, NeedsAThread) {
+  ASSERT_THROW(KeyFinder::ExecutionDomain("empty", 0), KeyFinder::Exception);
+}
+
+TEST (ExecutionDomainTest, RunsEveryTask) {
+  KeyFinder::ExecutionDomain d("batch", 3);
+  ASSERT_EQ("batch", d.getName());
+  ASSERT_EQ(3, d.getThreadCount());
+  std::atomic<unsigned int> done(0);
+  for (unsigned int i = 0; i < 20; i++) {
+    d.submit([&done]() { done++; });
+  }
+  d.wait();
+  ASSERT_EQ(20, done);
+  const KeyFinder::ExecutionDomainMetrics& m = d.getMetrics();
+  ASSERT_EQ(20, m.submitted);
+  ASSERT_EQ(20, m.completed);
+  ASSERT_EQ(0, m.failed);
+  ASSERT_EQ(0, m.bindFailures);
+  ASSERT_EQ(20, m.queueWait.getCount());
+  ASSERT_EQ(20, m.run.getCount());
+}
+
+TEST (ExecutionDomainTest, FuturesCarryFailures) {
+  KeyFinder::ExecutionDomain d("batch", 1);
+  std::future<void> f = d.submit([]() { throw std::runtime_error("failed task"); });
+  ASSERT_THROW(f.get(), std::runtime_error);
+  ASSERT_EQ(1, d.getMetrics().failed);
+  ASSERT_EQ(0, d.getMetrics().completed);
+}
+
+TEST (ExecutionDomainTest, DrainsQueueOnDestruction) {
+  std::atomic<unsigned int> done(0);
+  {
+    KeyFinder::ExecutionDomain d("batch", 1);
+    for (unsigned int i = 0; i < 10; i++) {
+      d.submit([&done]() { done++; });
+    }
+  }
+  ASSERT_EQ(10, done);
+}
+
+TEST (ExecutionDomainTest, CurrentOnlyOnItsOwnWorkers) {
+  KeyFinder::ExecutionDomain d("batch", 1);
+  KeyFinder::ExecutionDomain other("realtime", 1);
+  ASSERT_FALSE(d.isCurrent());
+  bool onWorker = false;
+  bool onOther = true;
+  d.submit([&]() { onWorker = d.isCurrent(); onOther = other.isCurrent(); }).get();
+  ASSERT_TRUE(onWorker);
+  ASSERT_FALSE(onOther);
+}
+
+#ifdef __linux__
+TEST (ExecutionDomainTest, PinsWorkersToItsCpus) {
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  ASSERT_EQ(0, sched_getaffinity(0, sizeof(allowed), &allowed));
+  unsigned int cpu = 0;
+  while (!CPU_ISSET(cpu, &allowed)) {
+    cpu++;
+  }
+
+  KeyFinder::ExecutionDomain d("realtime", 2, std::vector<unsigned int>(1, cpu));
+  cpu_set_t pinned;
+  CPU_ZERO(&pinned);
+  d.submit([&pinned]() { sched_getaffinity(0, sizeof(pinned), &pinned); }).get();
+  ASSERT_EQ(0, d.getMetrics().bindFailures);
+  ASSERT_EQ(1, CPU_COUNT(&pinned));
+  ASSERT_TRUE(CPU_ISSET(cpu, &pinned));
+}
+
+TEST (ExecutionDomainTest, UnbindRestoresTheProcessAffinity) {
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  ASSERT_EQ(0, sched_getaffinity(0, sizeof(allowed), &allowed));
+  unsigned int cpu = 0;
+  while (!CPU_ISSET(cpu, &allowed)) {
+    cpu++;
+  }
+
+  KeyFinder::ExecutionDomain d("realtime", 1, std::vector<unsigned int>(1, cpu));
+  cpu_set_t pinned;
+  cpu_set_t unpinned;
+  bool bound = false;
+  bool unbound = false;
+  // on a thread of its own, so the test runner is never pinned
+  std::thread t([&]() {
+    bound = d.bindCurrentThread();
+    sched_getaffinity(0, sizeof(pinned), &pinned);
+    unbound = KeyFinder::ExecutionDomain::unbindCurrentThread();
+    sched_getaffinity(0, sizeof(unpinned), &unpinned);
+  });
+  t.join();
+  ASSERT_TRUE(bound);
+  ASSERT_TRUE(unbound);
+  ASSERT_EQ(1, CPU_COUNT(&pinned));
+  ASSERT_TRUE(CPU_EQUAL(&allowed, &unpinned));
+}
+#endif
+
+TEST (ExecutionDomainTest, KeyOfChannelsRunsStreamsInTheDomain) {
+  KeyFinder::AudioData a = stereo_chord_audio(triad(440.0, true), triad(523.2511, false), 44100, 1.0);
+  KeyFinder::KeyFinder plain;
+  KeyFinder::ChannelKeys expected = plain.keyOfChannels(a, KeyFinder::CHANNELS_SEPARATE);
+
+  KeyFinder::ExecutionDomain d("batch", 2);
+  KeyFinder::KeyFinder kf;
+  kf.setExecutionDomain(&d);
+  KeyFinder::ChannelKeys confined = kf.keyOfChannels(a, KeyFinder::CHANNELS_SEPARATE);
+  ASSERT_EQ(expected.keys, confined.keys);
+  ASSERT_EQ(expected.mono, confined.mono);
+  ASSERT_EQ(3, d.getMetrics().completed);
+}
+
+TEST (ExecutionDomainTest, KeyOfChannelsFromInsideTheDomain) {
+  KeyFinder::AudioData a = stereo_chord_audio(triad(440.0, true), triad(523.2511, false), 44100, 1.0);
+  KeyFinder::ExecutionDomain d("batch", 1);
+  KeyFinder::KeyFinder kf;
+  kf.setExecutionDomain(&d);
+  KeyFinder::ChannelKeys result;
+  d.submit([&]() { result = kf.keyOfChannels(a, KeyFinder::CHANNELS_SEPARATE); }).get();
+  ASSERT_EQ(KeyFinder::A_MINOR, result.keys[0]);
+  ASSERT_EQ(KeyFinder::C_MAJOR, result.keys[1]);
+  ASSERT_EQ(1, d.getMetrics().completed);
+}
+
+TEST (ExecutionDomainTest, ShadowEvaluationJoinsTheDomain) {
+  KeyFinder::ExecutionDomain d("batch", 1, std::vector<unsigned int>(), KeyFinder::PRIORITY_BACKGROUND);
+  KeyFinder::KeyFinder kf;
+  kf.setExecutionDomain(&d);
+  kf.setShadowSampling(1);
+  kf.keyOfAudio(stereo_chord_audio(triad(440.0, true), triad(523.2511, false), 44100, 1.0));
+  kf.waitForShadowEvaluations();
+  ASSERT_EQ(1, kf.getShadowStatistics().evaluations);
+  ASSERT_EQ(0, kf.getShadowStatistics().keyMismatches);
+}
+
+TEST (ExecutionDomainTest, ShadowEvaluationOutlivesAClearedDomain) {
+  KeyFinder::KeyFinder kf;
+  kf.setShadowSampling(1);
+  {
+    KeyFinder::ExecutionDomain d("batch", 1);
+    kf.setExecutionDomain(&d);
+    kf.keyOfAudio(stereo_chord_audio(triad(440.0, true), triad(523.2511, false), 44100, 1.0));
+    kf.waitForShadowEvaluations();
+    kf.setExecutionDomain(NULL);
+  }
+  kf.keyOfAudio(stereo_chord_audio(triad(440.0, true), triad(523.2511, false), 44100, 1.0));
+  kf.waitForShadowEvaluations();
+  ASSERT_EQ(2, kf.getShadowStatistics().evaluations);
+  ASSERT_EQ(0, kf.getShadowStatistics().dropped);
+}
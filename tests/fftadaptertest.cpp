@@ -21,6 +21,9 @@
 
 #include "_testhelpers.h"
 
+#include <fstream>
+#include <iterator>
+
 TEST (FftAdapterTest, ForwardAndBackward) {
 
   unsigned int frameSize = 4096;
@@ -72,3 +75,39 @@ TEST (FftAdapterTest, ForwardAndBackward) {
     ASSERT_NEAR(original[i], backwards.getOutput(i), 0.001);
   }
 }
+
+TEST (FftAdapterTest, WisdomRoundTrip) {
+  const char* filename = "fftadaptertest.wisdom";
+  KeyFinder::setFftPlanMeasuring(true);
+  KeyFinder::FftAdapter* measured = new KeyFinder::FftAdapter(64);
+  KeyFinder::setFftPlanMeasuring(false);
+  KeyFinder::FftAdapter* estimated = new KeyFinder::FftAdapter(48);
+  ASSERT_EQ(std::string("measured"), measured->getPlanning());
+  ASSERT_EQ(std::string("estimated"), estimated->getPlanning());
+  delete estimated;
+  for (unsigned int i = 0; i < 64; i++) {
+    measured->setInput(i, sin(i * 0.5));
+  }
+  measured->execute();
+  KeyFinder::FftAdapter* fromWisdom = new KeyFinder::FftAdapter(64);
+  for (unsigned int i = 0; i < 64; i++) {
+    fromWisdom->setInput(i, sin(i * 0.5));
+  }
+  fromWisdom->execute();
+  ASSERT_EQ(std::string("wisdom"), fromWisdom->getPlanning());
+  for (unsigned int i = 0; i < 64; i++) {
+    ASSERT_NEAR(measured->getOutputMagnitude(i), fromWisdom->getOutputMagnitude(i), 0.000001);
+  }
+  delete measured;
+  delete fromWisdom;
+
+  ASSERT_TRUE(KeyFinder::exportFftWisdom(filename));
+  std::ifstream file(filename);
+  std::string wisdom((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  file.close();
+  // only the measured size leaves wisdom behind
+  ASSERT_NE(std::string::npos, wisdom.find("\n  (fftw_"));
+  ASSERT_TRUE(KeyFinder::importFftWisdom(filename));
+  remove(filename);
+  ASSERT_FALSE(KeyFinder::importFftWisdom(filename));
+}
@@ -0,0 +1,161 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#include "_testhelpers.h"
+
+TEST (HopCacheTest, StoreAndLookup) {
+  KeyFinder::HopCache c;
+  std::vector<double> row(BANDS, 0.5);
+  std::vector<double> found;
+  ASSERT_FALSE(c.lookup(42, 7, found));
+  c.store(42, 7, row);
+  ASSERT_TRUE(c.lookup(42, 7, found));
+  ASSERT_EQ(row, found);
+  ASSERT_EQ(1, c.getSize());
+  ASSERT_EQ(1, c.getHits());
+  ASSERT_EQ(1, c.getMisses());
+  c.clear();
+  ASSERT_EQ(0, c.getSize());
+  ASSERT_EQ(0, c.getHits());
+  ASSERT_FALSE(c.lookup(42, 7, found));
+}
+
+TEST (HopCacheTest, CollidingKeyIsAMiss) {
+  KeyFinder::HopCache c;
+  std::vector<double> row(BANDS, 0.5);
+  std::vector<double> other(BANDS, 0.25);
+  std::vector<double> found;
+  c.store(42, 7, row);
+  ASSERT_FALSE(c.lookup(42, 8, found));
+  ASSERT_EQ(0, c.getHits());
+  c.store(42, 8, other);
+  ASSERT_EQ(1, c.getSize());
+  ASSERT_TRUE(c.lookup(42, 8, found));
+  ASSERT_EQ(other, found);
+  ASSERT_FALSE(c.lookup(42, 7, found));
+}
+
+TEST (HopCacheTest, PolarityInvertedBlockIsAMiss) {
+  std::vector<double> a(HOPSIZE);
+  std::vector<double> inverted(HOPSIZE);
+  std::vector<double> b(HOPSIZE);
+  for (unsigned int i = 0; i < HOPSIZE; i++) {
+    a[i] = sin(i * 0.01) + 0.25;
+    inverted[i] = -a[i];
+    b[i] = cos(i * 0.03);
+  }
+  ASSERT_NE(KeyFinder::HopCache::checkOfBlock(&a[0], HOPSIZE), KeyFinder::HopCache::checkOfBlock(&inverted[0], HOPSIZE));
+
+  // a frame of one block next to another, then with the first inverted
+  std::vector<unsigned long long> hashes;
+  std::vector<unsigned long long> checks;
+  const double* blocks[] = { &a[0], &b[0], &inverted[0], &b[0] };
+  for (unsigned int i = 0; i < 4; i++) {
+    hashes.push_back(KeyFinder::HopCache::hashOfBlock(blocks[i], HOPSIZE));
+    checks.push_back(KeyFinder::HopCache::checkOfBlock(blocks[i], HOPSIZE));
+  }
+  KeyFinder::HopCache c;
+  std::vector<double> found;
+  c.store(KeyFinder::HopCache::combine(4410, hashes, 0, 2), KeyFinder::HopCache::combine(4410, checks, 0, 2), std::vector<double>(BANDS, 0.5));
+  ASSERT_FALSE(c.lookup(KeyFinder::HopCache::combine(4410, hashes, 2, 2), KeyFinder::HopCache::combine(4410, checks, 2, 2), found));
+  ASSERT_EQ(0, c.getHits());
+}
+
+TEST (HopCacheTest, EvictsLeastRecentlyUsed) {
+  KeyFinder::HopCache c(3);
+  ASSERT_EQ(3, c.getCapacity());
+  std::vector<double> found;
+  for (unsigned int i = 0; i < 3; i++) {
+    c.store(i, i, std::vector<double>(BANDS, i));
+  }
+  // touch the oldest so the second becomes least recently used
+  ASSERT_TRUE(c.lookup(0, 0, found));
+  c.store(3, 3, std::vector<double>(BANDS, 3));
+  ASSERT_EQ(3, c.getSize());
+  ASSERT_EQ(1, c.getEvictions());
+  ASSERT_TRUE(c.lookup(0, 0, found));
+  ASSERT_FALSE(c.lookup(1, 1, found));
+  ASSERT_TRUE(c.lookup(2, 2, found));
+  ASSERT_TRUE(c.lookup(3, 3, found));
+
+  c.setCapacity(1);
+  ASSERT_EQ(1, c.getSize());
+  ASSERT_EQ(3, c.getEvictions());
+  ASSERT_TRUE(c.lookup(3, 3, found));
+  ASSERT_EQ(std::vector<double>(BANDS, 3), found);
+
+  ASSERT_THROW(c.setCapacity(0), KeyFinder::Exception);
+  ASSERT_THROW(KeyFinder::HopCache(0), KeyFinder::Exception);
+}
+
+TEST (HopCacheTest, HashesDependOnContentAndOrder) {
+  double a[] = { 0.0, 0.25, -0.5, 1.0 };
+  double b[] = { 0.0, 0.25, -0.5, 1.0 };
+  double c[] = { 0.0, -0.5, 0.25, 1.0 };
+  double d[] = { -0.0, 0.25, -0.5, 1.0 };
+  ASSERT_EQ(KeyFinder::HopCache::hashOfBlock(a, 4), KeyFinder::HopCache::hashOfBlock(b, 4));
+  ASSERT_NE(KeyFinder::HopCache::hashOfBlock(a, 4), KeyFinder::HopCache::hashOfBlock(c, 4));
+  ASSERT_NE(KeyFinder::HopCache::hashOfBlock(a, 4), KeyFinder::HopCache::hashOfBlock(d, 4));
+
+  std::vector<unsigned long long> blocks;
+  blocks.push_back(1);
+  blocks.push_back(2);
+  blocks.push_back(1);
+  ASSERT_NE(KeyFinder::HopCache::combine(0, blocks, 0, 2), KeyFinder::HopCache::combine(0, blocks, 1, 2));
+  ASSERT_NE(KeyFinder::HopCache::combine(0, blocks, 0, 2), KeyFinder::HopCache::combine(1, blocks, 0, 2));
+  ASSERT_EQ(KeyFinder::HopCache::combine(7, blocks, 0, 1), KeyFinder::HopCache::combine(7, blocks, 2, 1));
+}
+
+TEST (HopCacheTest, ReanalysisOfTrimmedAudio) {
+  unsigned int sampleRate = 44100;
+  unsigned int seconds = 20;
+  KeyFinder::AudioData a;
+  a.setChannels(1);
+  a.setFrameRate(sampleRate);
+  a.addToSampleCount(sampleRate * seconds);
+  std::vector<float> aMinor = triad(440.0, true);
+  for (unsigned int i = 0; i < sampleRate * seconds; i++) {
+    float sample = chord_wave(i, aMinor, sampleRate);
+    // something that changes from hop to hop
+    sample += sine_wave(i, 110.0000 + i / 4410, sampleRate, 1);
+    a.setSample(i, sample);
+  }
+
+  KeyFinder::KeyFinder k;
+  KeyFinder::HopCache cache;
+  KeyFinder::key_t original = k.keyOfAudio(a, cache);
+  ASSERT_EQ(k.keyOfAudio(a), original);
+  ASSERT_EQ(0, cache.getHits());
+  unsigned int rows = cache.getSize();
+  ASSERT_GT(rows, 0);
+  unsigned int misses = cache.getMisses();
+
+  // trim an intro of exactly three hops at the downsampled rate
+  unsigned int trim = 3 * HOPSIZE * 10;
+  KeyFinder::AudioData* trimmed = a.copyFrames(trim, a.getFrameCount() - trim);
+  KeyFinder::key_t reanalysed = k.keyOfAudio(*trimmed, cache);
+  ASSERT_EQ(k.keyOfAudio(*trimmed), reanalysed);
+  // everything but the filter's run-in and the zero-padded tail is reused
+  ASSERT_GT(cache.getHits(), 0);
+  ASSERT_LE(cache.getMisses() - misses, 2);
+  ASSERT_LE(cache.getSize(), rows + 2);
+  delete trimmed;
+}
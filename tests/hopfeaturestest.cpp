@@ -0,0 +1,104 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#include "_testhelpers.h"
+
+TEST (HopFeaturesTest, AccessorsAndBounds) {
+  KeyFinder::HopFeatures f(2);
+  ASSERT_EQ(2, f.getHops());
+  ASSERT_FLOAT_EQ(0.0, f.getFeature(1, KeyFinder::FEATURE_PEAK));
+  f.setFeature(1, KeyFinder::FEATURE_PEAK, 0.5);
+  ASSERT_FLOAT_EQ(0.5, f.getFeature(1, KeyFinder::FEATURE_PEAK));
+  ASSERT_THROW(f.getFeature(2, KeyFinder::FEATURE_PEAK), KeyFinder::Exception);
+  ASSERT_THROW(f.setFeature(2, KeyFinder::FEATURE_PEAK, 0.5), KeyFinder::Exception);
+  ASSERT_THROW(f.setFeature(0, KeyFinder::FEATURE_PEAK, NAN), KeyFinder::Exception);
+
+  KeyFinder::HopFeatures g(3);
+  f.append(g);
+  ASSERT_EQ(5, f.getHops());
+  ASSERT_EQ(std::string("centroid"), KeyFinder::HopFeatures::featureName(KeyFinder::FEATURE_CENTROID));
+}
+
+TEST (HopFeaturesTest, SpectralFeaturesOfKnownSpectra) {
+  unsigned int frameSize = 16;
+  unsigned int frameRate = 1600;
+  KeyFinder::HopFeatures f(2);
+
+  // white: flat, centred, one unit of energy per bin
+  std::vector<double> flat(frameSize / 2 + 1, 1.0);
+  f.setSpectralFeatures(0, flat, frameRate, frameSize);
+  ASSERT_NEAR(1.0, f.getFeature(0, KeyFinder::FEATURE_FLATNESS), 1e-9);
+  ASSERT_FLOAT_EQ(400.0, f.getFeature(0, KeyFinder::FEATURE_CENTROID));
+  ASSERT_FLOAT_EQ(9.0, f.getFeature(0, KeyFinder::FEATURE_ENERGY));
+
+  // a single partial
+  std::vector<double> tone(frameSize / 2 + 1, 0.0);
+  tone[3] = 2.0;
+  f.setSpectralFeatures(1, tone, frameRate, frameSize);
+  ASSERT_LT(f.getFeature(1, KeyFinder::FEATURE_FLATNESS), 1e-6);
+  ASSERT_FLOAT_EQ(300.0, f.getFeature(1, KeyFinder::FEATURE_CENTROID));
+  ASSERT_FLOAT_EQ(4.0, f.getFeature(1, KeyFinder::FEATURE_ENERGY));
+}
+
+TEST (HopFeaturesTest, RowsFollowTheChromagram) {
+  unsigned int frameRate = 4410;
+  unsigned int packet = 5000;
+  KeyFinder::KeyFinder k;
+  KeyFinder::Workspace w;
+  KeyFinder::HopFeatures features;
+  w.features = &features;
+
+  for (unsigned int p = 0; p < 10; p++) {
+    KeyFinder::AudioData a;
+    a.setChannels(1);
+    a.setFrameRate(frameRate);
+    a.addToSampleCount(packet);
+    for (unsigned int i = 0; i < packet; i++) {
+      a.setSample(i, sine_wave(p * packet + i, 440.0, frameRate, 1));
+    }
+    k.progressiveChromagramAtAnalysisRate(a, w);
+    unsigned int hops = w.chromagram != NULL ? w.chromagram->getHops() : 0;
+    ASSERT_EQ(hops, features.getHops());
+  }
+  ASSERT_GT(features.getHops(), 0);
+  for (unsigned int h = 0; h < features.getHops(); h++) {
+    ASSERT_NEAR(sqrt(0.5), features.getFeature(h, KeyFinder::FEATURE_RMS), 0.01);
+    ASSERT_NEAR(1.0, features.getFeature(h, KeyFinder::FEATURE_PEAK), 0.01);
+    ASSERT_NEAR(440.0, features.getFeature(h, KeyFinder::FEATURE_CENTROID), 10.0);
+    ASSERT_LT(features.getFeature(h, KeyFinder::FEATURE_FLATNESS), 0.01);
+  }
+
+  k.finalChromagram(w);
+  ASSERT_EQ(w.chromagram->getHops(), features.getHops());
+}
+
+TEST (HopFeaturesTest, SpectraGiveSpectralFeaturesOnly) {
+  unsigned int frameSize = 16384;
+  std::vector< std::vector<double> > spectra(3, std::vector<double>(frameSize / 2 + 1, 1.0));
+  KeyFinder::KeyFinder k;
+  KeyFinder::Workspace w;
+  KeyFinder::HopFeatures features;
+  w.features = &features;
+  k.progressiveChromagramOfSpectra(spectra, frameSize, 4410, w);
+  ASSERT_EQ(3, features.getHops());
+  ASSERT_FLOAT_EQ(0.0, features.getFeature(2, KeyFinder::FEATURE_RMS));
+  ASSERT_NEAR(1.0, features.getFeature(2, KeyFinder::FEATURE_FLATNESS), 1e-9);
+}
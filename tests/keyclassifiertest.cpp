@@ -103,3 +103,68 @@ TEST (KeyClassifierTest, DetectsOtherTriads) {
   ASSERT_EQ(KeyFinder::G_MAJOR, kc.classify(gMajor));
 }
 */
+
+TEST (KeyClassifierTest, ScoresIncludeEveryKeyAndSilence) {
+  KeyFinder::KeyClassifier kc(KeyFinder::toneProfileMajor(), KeyFinder::toneProfileMinor());
+  std::vector<double> chroma(BANDS, 0.0);
+  chroma[24 + 0] = 1.0; // C
+  chroma[24 + 3] = 1.0; // E flat
+  chroma[24 + 7] = 1.0; // G
+
+  std::vector<double> scores = kc.scores(chroma);
+  ASSERT_EQ(KEYS + 1, scores.size());
+  ASSERT_FLOAT_EQ(0.0, scores[KeyFinder::SILENCE]);
+  for (unsigned int i = 0; i < KEYS; i++) {
+    ASSERT_LE(scores[i], scores[KeyFinder::C_MINOR]);
+  }
+  ASSERT_EQ(KeyFinder::C_MINOR, kc.classify(chroma));
+}
+
+TEST (KeyClassifierTest, StackedClassifierMatchesSingleClassifiers) {
+  std::vector<double> flat(BANDS, 1.0);
+  std::vector<double> skewed(BANDS, 0.0);
+  for (unsigned int i = 0; i < BANDS; i++) {
+    skewed[i] = (i * 7 % 12) + 1.0;
+  }
+
+  std::vector<KeyFinder::ToneProfileSet> sets;
+  sets.push_back(KeyFinder::ToneProfileSet(KeyFinder::toneProfileMajor(), KeyFinder::toneProfileMinor()));
+  sets.push_back(KeyFinder::ToneProfileSet(KeyFinder::toneProfileMinor(), KeyFinder::toneProfileMajor()));
+  sets.push_back(KeyFinder::ToneProfileSet(skewed, KeyFinder::toneProfileMinor()));
+  sets.push_back(KeyFinder::ToneProfileSet(flat, flat));
+  KeyFinder::StackedKeyClassifier stacked(sets);
+  ASSERT_EQ(4, stacked.getProfileSetCount());
+
+  // a spread of triads and noise-like vectors
+  for (unsigned int t = 0; t < 50; t++) {
+    std::vector<double> chroma(BANDS, 0.0);
+    for (unsigned int b = 0; b < BANDS; b++) {
+      chroma[b] = ((b * 31 + t * 17) % 23) / 100.0;
+    }
+    chroma[24 + (t % 12)] += 1.0;
+    chroma[24 + ((t + 3 + t % 2) % 12)] += 1.0;
+    chroma[24 + ((t + 7) % 12)] += 1.0;
+
+    std::vector<KeyFinder::key_t> keys = stacked.classify(chroma);
+    ASSERT_EQ(sets.size(), keys.size());
+    for (unsigned int s = 0; s < sets.size(); s++) {
+      KeyFinder::KeyClassifier single(sets[s].majorProfile, sets[s].minorProfile);
+      ASSERT_EQ(single.classify(chroma), keys[s]);
+    }
+  }
+
+  std::vector<double> silence(BANDS, 0.0);
+  std::vector<KeyFinder::key_t> keys = stacked.classify(silence);
+  for (unsigned int s = 0; s < sets.size(); s++) {
+    ASSERT_EQ(KeyFinder::SILENCE, keys[s]);
+  }
+}
+
+TEST (KeyClassifierTest, StackedClassifierBounds) {
+  std::vector<double> tooShort(BANDS - 1, 1.0);
+  ASSERT_THROW(KeyFinder::ToneProfileSet(tooShort, KeyFinder::toneProfileMinor()), KeyFinder::Exception);
+  std::vector<KeyFinder::ToneProfileSet> sets;
+  KeyFinder::StackedKeyClassifier empty(sets);
+  ASSERT_EQ(0, empty.classify(std::vector<double>(BANDS, 1.0)).size());
+  ASSERT_THROW(empty.classify(tooShort), KeyFinder::Exception);
+}
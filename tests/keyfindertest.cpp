@@ -113,6 +113,71 @@ TEST (KeyFinderTest, ProgressiveUseCase) {
   ASSERT_EQ(KeyFinder::A_MINOR, k.keyOfChromagram(w));
 }
 
+TEST (KeyFinderTest, PeekKeyUsesBufferedAudioWithoutMutatingWorkspace) {
+  unsigned int sampleRate = 44100;
+  KeyFinder::AudioData inputAudio = chord_audio(triad(440.0, true), sampleRate, 1.0 + 4.0 / sampleRate);
+
+  KeyFinder::KeyFinder k;
+  KeyFinder::Workspace w;
+
+  // a second of audio is not enough for a whole frame
+  k.progressiveChromagram(inputAudio, w);
+  ASSERT_EQ(0, w.chromagram->getHops());
+  ASSERT_EQ(KeyFinder::SILENCE, k.keyOfChromagram(w));
+  ASSERT_EQ(4410, w.preprocessedBuffer.getSampleCount());
+  ASSERT_EQ(4, w.remainderBuffer.getSampleCount());
+
+  KeyFinder::FftAdapter* fftPointer = w.fftAdapter;
+  ASSERT_EQ(KeyFinder::A_MINOR, k.peekKey(w));
+
+  ASSERT_EQ(0, w.chromagram->getHops());
+  ASSERT_EQ(4410, w.preprocessedBuffer.getSampleCount());
+  ASSERT_EQ(4, w.remainderBuffer.getSampleCount());
+  ASSERT_EQ(fftPointer, w.fftAdapter);
+
+  // and the provisional estimate agrees with the final one
+  k.finalChromagram(w);
+  ASSERT_EQ(KeyFinder::A_MINOR, k.keyOfChromagram(w));
+}
+
+TEST (KeyFinderTest, RepeatedPeeksReuseTheirFftPlan) {
+  unsigned int sampleRate = 44100;
+  KeyFinder::KeyFinder k;
+  KeyFinder::Workspace w;
+  k.progressiveChromagram(chord_audio(triad(440.0, true), sampleRate, 1.0), w);
+
+  ASSERT_EQ(KeyFinder::A_MINOR, k.peekKey(w));
+  unsigned long long plans = KeyFinder::getFftPlanCount();
+  for (unsigned int i = 0; i < 5; i++) {
+    ASSERT_EQ(KeyFinder::A_MINOR, k.peekKey(w));
+  }
+  ASSERT_EQ(plans, KeyFinder::getFftPlanCount());
+}
+
+TEST (KeyFinderTest, PeekKeyOfEmptyWorkspaceReturnsSilence) {
+  KeyFinder::Workspace w;
+  KeyFinder::KeyFinder kf;
+  ASSERT_EQ(KeyFinder::SILENCE, kf.peekKey(w));
+}
+
+TEST (KeyFinderTest, FinalChromagramOfDrainedWorkspaceAddsNoPadding) {
+  KeyFinder::AudioData a;
+  a.setChannels(1);
+  a.setFrameRate(4410);
+  a.addToSampleCount(FFTFRAMESIZE);
+  KeyFinder::KeyFinder kf;
+  KeyFinder::Workspace w;
+  kf.progressiveChromagramAtAnalysisRate(a, w);
+  ASSERT_EQ(1, w.chromagram->getHops());
+  w.preprocessedBuffer.discardFramesFromFront(w.preprocessedBuffer.getFrameCount());
+
+  KeyFinder::AnalysisDiagnostics d;
+  w.diagnostics = &d;
+  kf.finalChromagram(w);
+  ASSERT_EQ(0, d.paddingSamples);
+  ASSERT_EQ(1, w.chromagram->getHops());
+}
+
 TEST (KeyFinderTest, KeyOfChromagramReturnsSilence) {
   KeyFinder::Workspace w;
   w.chromagram = new KeyFinder::Chromagram(1);
@@ -140,3 +205,150 @@ TEST (KeyFinderTest, KeyOfChromagramCollapsesTimeDimension) {
   KeyFinder::KeyFinder kf;
   ASSERT_EQ(KeyFinder::C_MINOR, kf.keyOfChromagram(w));
 }
+
+TEST (KeyFinderTest, KeyOfRegionAnalysesOnlyTheRegion) {
+  unsigned int sampleRate = 44100;
+  // A minor in the middle second, C major either side
+  std::vector< std::vector<float> > chords;
+  chords.push_back(triad(523.2511, false));
+  chords.push_back(triad(440.0, true));
+  chords.push_back(triad(523.2511, false));
+  KeyFinder::AudioData inputAudio = chord_audio(chords, sampleRate, 1.0);
+  KeyFinder::KeyFinder kf;
+  ASSERT_EQ(KeyFinder::A_MINOR, kf.keyOfRegion(inputAudio, 1.0, 2.0));
+  ASSERT_EQ(KeyFinder::C_MAJOR, kf.keyOfRegion(inputAudio, 0.0, 1.0));
+  ASSERT_EQ(KeyFinder::C_MAJOR, kf.keyOfRegion(inputAudio, 2.0, 10.0));
+}
+
+TEST (KeyFinderTest, KeyOfRegionMatchesKeyOfAudioForWholeFile) {
+  unsigned int sampleRate = 44100;
+  KeyFinder::AudioData inputAudio = chord_audio(triad(440.0, true), sampleRate, 1.0);
+  KeyFinder::KeyFinder kf;
+  ASSERT_EQ(kf.keyOfAudio(inputAudio), kf.keyOfRegion(inputAudio, 0.0, 1.0));
+}
+
+TEST (KeyFinderTest, KeyOfRegionBounds) {
+  KeyFinder::AudioData inputAudio;
+  inputAudio.setChannels(1);
+  inputAudio.setFrameRate(44100);
+  inputAudio.addToSampleCount(44100);
+  KeyFinder::KeyFinder kf;
+  ASSERT_THROW(kf.keyOfRegion(inputAudio, -1.0, 0.5), KeyFinder::Exception);
+  ASSERT_THROW(kf.keyOfRegion(inputAudio, 0.5, 0.5), KeyFinder::Exception);
+  ASSERT_THROW(kf.keyOfRegion(inputAudio, 2.0, 3.0), KeyFinder::Exception);
+  ASSERT_EQ(KeyFinder::SILENCE, kf.keyOfRegion(inputAudio, 0.25, 0.75));
+}
+
+TEST (KeyFinderTest, KeyOfAudioWithSeveralProfileSets) {
+  unsigned int sampleRate = 44100;
+  KeyFinder::AudioData inputAudio = chord_audio(triad(440.0, true), sampleRate, 1.0);
+
+  std::vector<KeyFinder::ToneProfileSet> sets;
+  sets.push_back(KeyFinder::ToneProfileSet(KeyFinder::toneProfileMajor(), KeyFinder::toneProfileMinor()));
+  sets.push_back(KeyFinder::ToneProfileSet(KeyFinder::toneProfileMinor(), KeyFinder::toneProfileMajor()));
+  KeyFinder::StackedKeyClassifier classifier(sets);
+
+  KeyFinder::KeyFinder kf;
+  std::vector<KeyFinder::key_t> keys = kf.keyOfAudio(inputAudio, classifier);
+  ASSERT_EQ(2, keys.size());
+  ASSERT_EQ(kf.keyOfAudio(inputAudio), keys[0]);
+  ASSERT_EQ(KeyFinder::A_MINOR, keys[0]);
+  // with the profiles swapped, the minor triad reads as a major key
+  ASSERT_EQ(KeyFinder::A_MAJOR, keys[1]);
+
+  KeyFinder::Workspace w;
+  kf.progressiveChromagram(inputAudio, w);
+  kf.finalChromagram(w);
+  std::vector<KeyFinder::key_t> streamed = kf.keyOfChromagram(w, classifier);
+  ASSERT_EQ(keys[0], streamed[0]);
+  ASSERT_EQ(keys[1], streamed[1]);
+}
+
+TEST (KeyFinderTest, KeyOfChannels) {
+  unsigned int sampleRate = 44100;
+  KeyFinder::AudioData inputAudio = stereo_chord_audio(triad(440.0, true), triad(523.2511, false), sampleRate, 1.0);
+
+  KeyFinder::KeyFinder kf;
+  KeyFinder::ChannelKeys separate = kf.keyOfChannels(inputAudio, KeyFinder::CHANNELS_SEPARATE);
+  ASSERT_EQ(2, separate.keys.size());
+  ASSERT_EQ(2, separate.chromaVectors.size());
+  ASSERT_EQ(BANDS, separate.chromaVectors[0].size());
+  ASSERT_EQ(KeyFinder::A_MINOR, separate.keys[0]);
+  ASSERT_EQ(KeyFinder::C_MAJOR, separate.keys[1]);
+  ASSERT_EQ(kf.keyOfAudio(inputAudio), separate.mono);
+
+  KeyFinder::ChannelKeys midSide = kf.keyOfChannels(inputAudio, KeyFinder::CHANNELS_MID_SIDE);
+  ASSERT_EQ(2, midSide.keys.size());
+  ASSERT_EQ(midSide.keys[0], midSide.mono);
+  ASSERT_EQ(separate.mono, midSide.mono);
+}
+
+TEST (KeyFinderTest, KeyOfChannelsMidSideOfDualMono) {
+  unsigned int sampleRate = 44100;
+  KeyFinder::AudioData inputAudio = stereo_chord_audio(triad(440.0, true), triad(440.0, true), sampleRate, 1.0);
+
+  KeyFinder::KeyFinder kf;
+  KeyFinder::ChannelKeys midSide = kf.keyOfChannels(inputAudio, KeyFinder::CHANNELS_MID_SIDE);
+  ASSERT_EQ(KeyFinder::A_MINOR, midSide.keys[0]);
+  ASSERT_EQ(KeyFinder::SILENCE, midSide.keys[1]);
+
+  KeyFinder::AudioData monoAudio;
+  monoAudio.setChannels(1);
+  monoAudio.setFrameRate(sampleRate);
+  monoAudio.addToFrameCount(sampleRate);
+  ASSERT_THROW(kf.keyOfChannels(monoAudio, KeyFinder::CHANNELS_MID_SIDE), KeyFinder::Exception);
+}
+
+TEST (KeyFinderTest, PrewarmLeavesResultsUnchanged) {
+  KeyFinder::AudioData a = chord_audio(triad(440.0, true), 44100, 1.0);
+  KeyFinder::KeyFinder k;
+  k.prewarm(44100);
+  k.prewarm(48000);
+  ASSERT_EQ(KeyFinder::A_MINOR, k.keyOfAudio(a));
+}
+
+TEST (KeyFinderTest, KeyOfAudioAtAnalysisRate) {
+  unsigned int analysisRate = 4410;
+  KeyFinder::AudioData a = chord_audio(triad(440.0, true), analysisRate, 10.0);
+  KeyFinder::KeyFinder k;
+  ASSERT_EQ(KeyFinder::A_MINOR, k.keyOfAudioAtAnalysisRate(a));
+
+  a.setChannels(2);
+  ASSERT_THROW(k.keyOfAudioAtAnalysisRate(a), KeyFinder::Exception);
+}
+
+TEST (KeyFinderTest, KeyOfSpectra) {
+  unsigned int frameRate = 8000;
+  unsigned int frameSize = 8192;
+  unsigned int hopSize = 2048;
+  KeyFinder::TemporalWindowFactory twf;
+  std::shared_ptr<const std::vector<double> > tw = twf.getTemporalWindow(frameSize);
+
+  KeyFinder::FftAdapter fft(frameSize);
+  std::vector<float> cMajor = triad(261.6256, false);
+  std::vector< std::vector<double> > spectra;
+  for (unsigned int hop = 0; hop < 8; hop++) {
+    for (unsigned int i = 0; i < frameSize; i++) {
+      unsigned int t = hop * hopSize + i;
+      fft.setInput(i, (*tw)[i] * chord_wave(t, cMajor, frameRate));
+    }
+    fft.execute();
+    std::vector<double> magnitudes(frameSize / 2 + 1);
+    for (unsigned int i = 0; i < magnitudes.size(); i++) {
+      magnitudes[i] = fft.getOutputMagnitude(i);
+    }
+    spectra.push_back(magnitudes);
+  }
+
+  KeyFinder::KeyFinder k;
+  ASSERT_EQ(KeyFinder::C_MAJOR, k.keyOfSpectra(spectra, frameSize, frameRate));
+
+  KeyFinder::Workspace w;
+  k.progressiveChromagramOfSpectra(std::vector< std::vector<double> >(spectra.begin(), spectra.begin() + 4), frameSize, frameRate, w);
+  k.progressiveChromagramOfSpectra(std::vector< std::vector<double> >(spectra.begin() + 4, spectra.end()), frameSize, frameRate, w);
+  ASSERT_EQ(8, w.chromagram->getHops());
+  ASSERT_EQ(KeyFinder::C_MAJOR, k.keyOfChromagram(w));
+
+  spectra[3].resize(frameSize / 4);
+  ASSERT_THROW(k.keyOfSpectra(spectra, frameSize, frameRate), KeyFinder::Exception);
+}
@@ -0,0 +1,138 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#include "_testhelpers.h"
+
+TEST (LatencyHistogramTest, EmptyHistogram) {
+  KeyFinder::LatencyHistogram h;
+  ASSERT_EQ(0, h.getCount());
+  ASSERT_EQ(0, h.getMax());
+  ASSERT_FLOAT_EQ(0.0, h.getMean());
+  ASSERT_EQ(0, h.percentile(99.9));
+}
+
+TEST (LatencyHistogramTest, SmallValuesAreExact) {
+  KeyFinder::LatencyHistogram h;
+  for (unsigned int i = 1; i <= 50; i++) {
+    h.record(i);
+  }
+  ASSERT_EQ(50, h.getCount());
+  ASSERT_EQ(50, h.getMax());
+  ASSERT_FLOAT_EQ(25.5, h.getMean());
+  ASSERT_EQ(1, h.percentile(0.0));
+  ASSERT_EQ(25, h.percentile(50.0));
+  ASSERT_EQ(50, h.percentile(100.0));
+  ASSERT_THROW(h.percentile(100.1), KeyFinder::Exception);
+}
+
+TEST (LatencyHistogramTest, LargeValuesWithinPrecision) {
+  KeyFinder::LatencyHistogram h;
+  unsigned long long values[] = { 100, 1000, 12345, 999999, 123456789, 98765432101ULL };
+  for (unsigned int i = 0; i < 6; i++) {
+    KeyFinder::LatencyHistogram single;
+    single.record(values[i]);
+    single.record(1);
+    unsigned long long reported = single.percentile(100.0);
+    ASSERT_EQ(values[i], reported);
+    // the upper bound of the bucket, rather than the exact maximum
+    single.record(values[i] * 2);
+    reported = single.percentile(66.0);
+    ASSERT_GE(reported, values[i]);
+    ASSERT_LE(reported, values[i] + values[i] / 32);
+  }
+  h.record(~0ULL);
+  ASSERT_EQ(~0ULL, h.percentile(100.0));
+}
+
+TEST (LatencyHistogramTest, TailPercentiles) {
+  KeyFinder::LatencyHistogram h;
+  for (unsigned int i = 0; i < 9990; i++) {
+    h.record(1000);
+  }
+  for (unsigned int i = 0; i < 10; i++) {
+    h.record(5000000);
+  }
+  ASSERT_LE(h.percentile(99.0), 1000 + 1000 / 32);
+  ASSERT_LE(h.percentile(99.9), 1000 + 1000 / 32);
+  ASSERT_GE(h.percentile(99.91), 5000000);
+  ASSERT_EQ(5000000, h.getMax());
+}
+
+TEST (LatencyHistogramTest, MergeAcrossThreads) {
+  KeyFinder::LatencyHistogram shared;
+  KeyFinder::LatencyHistogram perThread[4];
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0; t < 4; t++) {
+    threads.push_back(std::thread([&shared, &perThread, t]() {
+      for (unsigned int i = 0; i < 10000; i++) {
+        shared.record(t * 10000 + i);
+        perThread[t].record(t * 10000 + i);
+      }
+    }));
+  }
+  for (unsigned int t = 0; t < 4; t++) {
+    threads[t].join();
+  }
+  KeyFinder::LatencyHistogram merged;
+  for (unsigned int t = 0; t < 4; t++) {
+    merged.merge(perThread[t]);
+  }
+  ASSERT_EQ(40000, shared.getCount());
+  ASSERT_EQ(40000, merged.getCount());
+  ASSERT_EQ(39999, merged.getMax());
+  ASSERT_FLOAT_EQ(shared.getMean(), merged.getMean());
+  ASSERT_EQ(shared.percentile(50.0), merged.percentile(50.0));
+  ASSERT_EQ(shared.percentile(99.9), merged.percentile(99.9));
+  merged.clear();
+  ASSERT_EQ(0, merged.getCount());
+}
+
+TEST (LatencyHistogramTest, StreamingMetrics) {
+  KeyFinder::AudioData a;
+  a.setChannels(1);
+  a.setFrameRate(44100);
+  a.addToFrameCount(441000);
+
+  KeyFinder::KeyFinder k;
+  KeyFinder::Workspace w;
+  KeyFinder::StreamingMetrics m;
+  w.metrics = &m;
+
+  for (unsigned int i = 0; i < 3; i++) {
+    k.progressiveChromagram(a, w);
+    k.keyOfChromagram(w);
+  }
+  unsigned int hops = w.chromagram->getHops();
+  k.finalChromagram(w);
+
+  ASSERT_EQ(3, m.progressiveChromagram.getCount());
+  ASSERT_EQ(3, m.keyOfChromagram.getCount());
+  ASSERT_EQ(1, m.finalChromagram.getCount());
+  ASSERT_EQ(3, m.hopsPerCall.getCount());
+  ASSERT_GT(m.progressiveChromagram.getMax(), 0);
+  ASSERT_GT(hops, 0);
+  ASSERT_FLOAT_EQ(hops, m.hopsPerCall.getMean() * 3);
+
+  std::ostringstream report;
+  m.write(report);
+  ASSERT_TRUE(report.str().find("progressiveChromagram count 3 ") == 0);
+  ASSERT_TRUE(report.str().find("hopsPerCall count 3 ") != std::string::npos);
+}
@@ -0,0 +1,108 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#include "_testhelpers.h"
+
+// temporal windows are the simplest plans to size: a vector of doubles
+static size_t windowBytes(unsigned int frameSize) {
+  return sizeof(std::vector<double>) + frameSize * sizeof(double);
+}
+
+TEST (PlanRegistryTest, SharedAcrossFactoriesAndKeyFinders) {
+  KeyFinder::ChromaTransformFactory ctf1;
+  KeyFinder::ChromaTransformFactory ctf2;
+  std::shared_ptr<const KeyFinder::ChromaTransform> ct1 = ctf1.getChromaTransform(4410);
+  std::shared_ptr<const KeyFinder::ChromaTransform> ct2 = ctf2.getChromaTransform(4410);
+  ASSERT_EQ(ct1, ct2);
+
+  KeyFinder::KeyFinder k1;
+  KeyFinder::KeyFinder k2;
+  k1.prewarm(44100);
+  size_t entries = KeyFinder::PlanRegistry::shared().getEntries();
+  k2.prewarm(44100);
+  ASSERT_EQ(entries, KeyFinder::PlanRegistry::shared().getEntries());
+}
+
+TEST (PlanRegistryTest, EvictsUnreferencedLeastRecentlyUsed) {
+  KeyFinder::PlanRegistry r(50000);
+  r.getTemporalWindow(1000);
+  r.getTemporalWindow(2000);
+  r.getTemporalWindow(3000);
+  ASSERT_EQ(3, r.getEntries());
+  ASSERT_EQ(windowBytes(1000) + windowBytes(2000) + windowBytes(3000), r.getBytes());
+  ASSERT_EQ(0, r.getEvictions());
+
+  r.getTemporalWindow(1000);
+  r.getTemporalWindow(4000);
+  ASSERT_EQ(2, r.getEntries());
+  ASSERT_EQ(2, r.getEvictions());
+  ASSERT_EQ(windowBytes(1000) + windowBytes(4000), r.getBytes());
+
+  r.getTemporalWindow(1000);
+  ASSERT_EQ(2, r.getEntries());
+}
+
+TEST (PlanRegistryTest, ReferencedPlansAreNotEvicted) {
+  KeyFinder::PlanRegistry r(10000);
+  std::shared_ptr<const std::vector<double> > held = r.getTemporalWindow(2000);
+  ASSERT_EQ(1, r.getEntries());
+  ASSERT_GT(r.getBytes(), r.getMemoryCap());
+
+  std::shared_ptr<const std::vector<double> > again = r.getTemporalWindow(2000);
+  ASSERT_EQ(held, again);
+  held.reset();
+  r.setMemoryCap(20000);
+  ASSERT_EQ(1, r.getEntries());
+
+  r.setMemoryCap(0);
+  ASSERT_EQ(1, r.getEntries());
+  again.reset();
+  r.setMemoryCap(0);
+  ASSERT_EQ(0, r.getEntries());
+  ASSERT_EQ(0, r.getBytes());
+}
+
+TEST (PlanRegistryTest, HandlesOutliveTheRegistry) {
+  std::shared_ptr<const std::vector<double> > survivor;
+  {
+    KeyFinder::PlanRegistry r;
+    survivor = r.getTemporalWindow(3000);
+  }
+  ASSERT_EQ(3000, survivor->size());
+}
+
+TEST (PlanRegistryTest, RacingBuildsShareOnePlan) {
+  KeyFinder::PlanRegistry r;
+  std::vector< std::shared_ptr<const KeyFinder::ChromaTransform> > built(4);
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0; t < built.size(); t++) {
+    threads.push_back(std::thread([&r, &built, t]() {
+      built[t] = r.getChromaTransform(4410, 16384);
+    }));
+  }
+  for (unsigned int t = 0; t < threads.size(); t++) {
+    threads[t].join();
+  }
+  ASSERT_EQ(1, r.getEntries());
+  for (unsigned int t = 1; t < built.size(); t++) {
+    ASSERT_EQ(built[0], built[t]);
+  }
+}
@@ -0,0 +1,327 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+/*************************************************************************
+
+  Checks that the steady-state streaming path is safe to call from a
+  real-time audio thread: that progressiveChromagram and keyOfChromagram
+  never allocate or free memory, lock a mutex, or make blocking system
+  calls once a stream is under way.
+
+  Usage: rtsafety [--frames N] [--channels N] [--rate HZ] [--packets N]
+                  [--key-every N]
+
+  The harness replaces malloc and friends, pthread_mutex_lock and
+  trylock, and the libc wrappers for open, read, write, mmap, munmap and
+  nanosleep. After a warm-up stream, the replacements are armed on the
+  calling thread only for the duration of each library call; any call
+  into them while armed is a violation. Violations are counted by kind,
+  the first few of each kind are printed with a backtrace (where the C
+  library supports it), and the exit status is non-zero.
+
+  Packets are copied into AudioData objects before the calls are armed,
+  but progressiveChromagram takes its audio by value, so the copy made
+  for each call is counted: the API itself is part of the real-time path.
+
+  Linux only; it is kept out of the main test suite because the streaming
+  path does not yet pass it.
+
+*************************************************************************/
+
+#include "keyfinder/keyfinder.h"
+
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __GLIBC__
+#include <execinfo.h>
+#endif
+
+enum violation_t {
+  VIOLATION_MALLOC,
+  VIOLATION_FREE,
+  VIOLATION_MUTEX,
+  VIOLATION_SYSCALL,
+  VIOLATIONS
+};
+
+static const char* VIOLATION_NAMES[] = { "allocation", "free", "mutex lock", "system call" };
+
+static thread_local bool armed = false;
+static std::atomic<unsigned long long> counts[VIOLATIONS];
+
+static const unsigned int SAMPLES_PER_KIND = 3;
+static const unsigned int SAMPLE_FRAMES = 16;
+static void* samples[VIOLATIONS][SAMPLES_PER_KIND][SAMPLE_FRAMES];
+static int sampleDepths[VIOLATIONS][SAMPLES_PER_KIND];
+static const char* sampleCalls[VIOLATIONS][SAMPLES_PER_KIND];
+
+static void violation(violation_t kind, const char* call) {
+  if (!armed) {
+    return;
+  }
+  armed = false; // nothing below may count against itself
+  unsigned long long n = counts[kind].fetch_add(1);
+  if (n < SAMPLES_PER_KIND) {
+    sampleCalls[kind][n] = call;
+#ifdef __GLIBC__
+    sampleDepths[kind][n] = backtrace(samples[kind][n], SAMPLE_FRAMES);
+#endif
+  }
+  armed = true;
+}
+
+// ============================== interposition ==============================
+
+// dlsym may itself allocate, before the real allocator is known
+static char bootstrap[16384];
+static size_t bootstrapUsed = 0;
+static bool resolving = false;
+
+static void* (*realMalloc)(size_t) = NULL;
+static void  (*realFree)(void*) = NULL;
+static void* (*realCalloc)(size_t, size_t) = NULL;
+static void* (*realRealloc)(void*, size_t) = NULL;
+static int   (*realPosixMemalign)(void**, size_t, size_t) = NULL;
+static int   (*realMutexLock)(pthread_mutex_t*) = NULL;
+static int   (*realMutexTrylock)(pthread_mutex_t*) = NULL;
+static int   (*realOpen)(const char*, int, ...) = NULL;
+static ssize_t (*realRead)(int, void*, size_t) = NULL;
+static ssize_t (*realWrite)(int, const void*, size_t) = NULL;
+static void* (*realMmap)(void*, size_t, int, int, int, off_t) = NULL;
+static int   (*realMunmap)(void*, size_t) = NULL;
+static int   (*realNanosleep)(const struct timespec*, struct timespec*) = NULL;
+
+template <typename F>
+static void resolve(F& f, const char* name) {
+  if (f == NULL) {
+    resolving = true;
+    f = (F)dlsym(RTLD_NEXT, name);
+    resolving = false;
+  }
+}
+
+static void* bootstrapAlloc(size_t size) {
+  size = (size + 15) & ~(size_t)15;
+  if (bootstrapUsed + size > sizeof(bootstrap)) {
+    abort();
+  }
+  void* p = bootstrap + bootstrapUsed;
+  bootstrapUsed += size;
+  return p;
+}
+
+static bool isBootstrap(void* p) {
+  return (char*)p >= bootstrap && (char*)p < bootstrap + sizeof(bootstrap);
+}
+
+extern "C" {
+
+  void* malloc(size_t size) {
+    if (resolving) return bootstrapAlloc(size);
+    resolve(realMalloc, "malloc");
+    violation(VIOLATION_MALLOC, "malloc");
+    return realMalloc(size);
+  }
+
+  void free(void* p) {
+    if (p == NULL || isBootstrap(p)) return;
+    resolve(realFree, "free");
+    violation(VIOLATION_FREE, "free");
+    realFree(p);
+  }
+
+  void* calloc(size_t count, size_t size) {
+    if (resolving) return bootstrapAlloc(count * size); // static, so already zero
+    resolve(realCalloc, "calloc");
+    violation(VIOLATION_MALLOC, "calloc");
+    return realCalloc(count, size);
+  }
+
+  void* realloc(void* p, size_t size) {
+    if (isBootstrap(p)) {
+      void* q = malloc(size);
+      memcpy(q, p, size);
+      return q;
+    }
+    resolve(realRealloc, "realloc");
+    violation(VIOLATION_MALLOC, "realloc");
+    return realRealloc(p, size);
+  }
+
+  int posix_memalign(void** p, size_t alignment, size_t size) {
+    resolve(realPosixMemalign, "posix_memalign");
+    violation(VIOLATION_MALLOC, "posix_memalign");
+    return realPosixMemalign(p, alignment, size);
+  }
+
+  int pthread_mutex_lock(pthread_mutex_t* m) {
+    resolve(realMutexLock, "pthread_mutex_lock");
+    violation(VIOLATION_MUTEX, "pthread_mutex_lock");
+    return realMutexLock(m);
+  }
+
+  int pthread_mutex_trylock(pthread_mutex_t* m) {
+    resolve(realMutexTrylock, "pthread_mutex_trylock");
+    violation(VIOLATION_MUTEX, "pthread_mutex_trylock");
+    return realMutexTrylock(m);
+  }
+
+  int open(const char* path, int flags, ...) {
+    va_list args;
+    va_start(args, flags);
+    int mode = (flags & O_CREAT) ? va_arg(args, int) : 0;
+    va_end(args);
+    resolve(realOpen, "open");
+    violation(VIOLATION_SYSCALL, "open");
+    return realOpen(path, flags, mode);
+  }
+
+  ssize_t read(int fd, void* buffer, size_t count) {
+    resolve(realRead, "read");
+    violation(VIOLATION_SYSCALL, "read");
+    return realRead(fd, buffer, count);
+  }
+
+  ssize_t write(int fd, const void* buffer, size_t count) {
+    resolve(realWrite, "write");
+    violation(VIOLATION_SYSCALL, "write");
+    return realWrite(fd, buffer, count);
+  }
+
+  void* mmap(void* address, size_t length, int protection, int flags, int fd, off_t offset) {
+    resolve(realMmap, "mmap");
+    violation(VIOLATION_SYSCALL, "mmap");
+    return realMmap(address, length, protection, flags, fd, offset);
+  }
+
+  int munmap(void* address, size_t length) {
+    resolve(realMunmap, "munmap");
+    violation(VIOLATION_SYSCALL, "munmap");
+    return realMunmap(address, length);
+  }
+
+  int nanosleep(const struct timespec* duration, struct timespec* remaining) {
+    resolve(realNanosleep, "nanosleep");
+    violation(VIOLATION_SYSCALL, "nanosleep");
+    return realNanosleep(duration, remaining);
+  }
+
+}
+
+// ================================= harness =================================
+
+static KeyFinder::AudioData packetOf(unsigned int frames, unsigned int channels, unsigned int frameRate, unsigned int firstFrame) {
+  KeyFinder::AudioData a;
+  a.setChannels(channels);
+  a.setFrameRate(frameRate);
+  a.addToFrameCount(frames);
+  for (unsigned int f = 0; f < frames; f++) {
+    double t = (firstFrame + f) / (double)frameRate;
+    double sample = (sin(t * 440.0000 * 2.0 * PI) + sin(t * 523.2511 * 2.0 * PI) + sin(t * 659.2551 * 2.0 * PI)) / 3.0;
+    for (unsigned int c = 0; c < channels; c++) {
+      a.setSampleByFrame(f, c, sample);
+    }
+  }
+  return a;
+}
+
+int main(int argc, char** argv) {
+
+  unsigned int frames = 512;
+  unsigned int channels = 2;
+  unsigned int frameRate = 44100;
+  unsigned int packets = 2000;
+  unsigned int keyEvery = 10;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if (strcmp(argv[i], "--frames") == 0) frames = atoi(argv[i + 1]);
+    else if (strcmp(argv[i], "--channels") == 0) channels = atoi(argv[i + 1]);
+    else if (strcmp(argv[i], "--rate") == 0) frameRate = atoi(argv[i + 1]);
+    else if (strcmp(argv[i], "--packets") == 0) packets = atoi(argv[i + 1]);
+    else if (strcmp(argv[i], "--key-every") == 0) keyEvery = atoi(argv[i + 1]);
+  }
+  if (frames < 1 || channels < 1 || keyEvery < 1) {
+    fprintf(stderr, "frames, channels and key-every must be positive\n");
+    return 2;
+  }
+
+#ifdef __GLIBC__
+  // the first backtrace loads the unwinder, which allocates
+  void* frame[1];
+  backtrace(frame, 1);
+#endif
+
+  static KeyFinder::KeyFinder k;
+  KeyFinder::Workspace w;
+  k.prewarm(frameRate);
+
+  // warm up with enough audio for a few whole FFT frames
+  unsigned int position = 0;
+  unsigned int warmUpFrames = 4 * FFTFRAMESIZE * (frameRate / 4410 + 1);
+  while (position < warmUpFrames) {
+    k.progressiveChromagram(packetOf(frames, channels, frameRate, position), w);
+    position += frames;
+  }
+  k.keyOfChromagram(w);
+
+  std::vector<KeyFinder::AudioData> audio;
+  for (unsigned int p = 0; p < packets; p++) {
+    audio.push_back(packetOf(frames, channels, frameRate, position));
+    position += frames;
+  }
+
+  for (unsigned int p = 0; p < packets; p++) {
+    armed = true;
+    k.progressiveChromagram(audio[p], w);
+    if (p % keyEvery == keyEvery - 1) {
+      k.keyOfChromagram(w);
+    }
+    armed = false;
+  }
+
+  unsigned long long total = 0;
+  printf("%u packets of %u frames, %u channels at %uHz, key every %u packets\n", packets, frames, channels, frameRate, keyEvery);
+  for (unsigned int kind = 0; kind < VIOLATIONS; kind++) {
+    unsigned long long n = counts[kind].load();
+    total += n;
+    printf("%-12s %llu (%.2f per packet)\n", VIOLATION_NAMES[kind], n, n / (double)packets);
+  }
+  for (unsigned int kind = 0; kind < VIOLATIONS; kind++) {
+    for (unsigned int s = 0; s < SAMPLES_PER_KIND && s < counts[kind].load(); s++) {
+      printf("\n%s in %s:\n", VIOLATION_NAMES[kind], sampleCalls[kind][s]);
+      fflush(stdout);
+#ifdef __GLIBC__
+      backtrace_symbols_fd(samples[kind][s], sampleDepths[kind][s], fileno(stdout));
+#endif
+    }
+  }
+  printf("\n%s\n", total == 0 ? "PASS: no real-time violations" : "FAIL: real-time violations found");
+
+  return total == 0 ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#include "_testhelpers.h"
+
+TEST (ShadowEvaluatorTest, DisabledByDefault) {
+  KeyFinder::KeyFinder k;
+  k.keyOfAudio(chord_audio(triad(440.0, true), 44100, 1.0));
+  k.waitForShadowEvaluations();
+  KeyFinder::ShadowStatistics s = k.getShadowStatistics();
+  ASSERT_EQ(0, s.requests);
+  ASSERT_EQ(0, s.evaluations);
+}
+
+TEST (ShadowEvaluatorTest, SampledRequestsMatchReference) {
+  KeyFinder::AudioData a = chord_audio(triad(440.0, true), 44100, 1.0);
+  KeyFinder::KeyFinder k;
+  k.setShadowSampling(2);
+  for (unsigned int i = 0; i < 4; i++) {
+    ASSERT_EQ(KeyFinder::A_MINOR, k.keyOfAudio(a));
+    k.waitForShadowEvaluations();
+  }
+  KeyFinder::ShadowStatistics s = k.getShadowStatistics();
+  ASSERT_EQ(4, s.requests);
+  ASSERT_EQ(2, s.evaluations);
+  ASSERT_EQ(0, s.dropped);
+  ASSERT_EQ(0, s.keyMismatches);
+  ASSERT_NEAR(0.0, s.meanScoreMarginDifference, TINY);
+  ASSERT_NEAR(0.0, s.maxChromaCosineDistance, TINY);
+  ASSERT_GT(s.primarySeconds, 0.0);
+  ASSERT_GT(s.referenceSeconds, 0.0);
+}
+
+TEST (ShadowEvaluatorTest, DetectsDivergence) {
+  KeyFinder::ShadowEvaluator se;
+  se.setSampling(1);
+  ASSERT_TRUE(se.sample());
+
+  std::vector<double> cMinor(BANDS, 0.0);
+  cMinor[24 + 0] = 1.0;
+  cMinor[24 + 3] = 1.0;
+  cMinor[24 + 7] = 1.0;
+  se.evaluate(chord_audio(triad(440.0, true), 44100, 1.0), cMinor, 0.01);
+  se.wait();
+
+  KeyFinder::ShadowStatistics s = se.getStatistics();
+  ASSERT_EQ(1, s.evaluations);
+  ASSERT_EQ(1, s.keyMismatches);
+  ASSERT_GT(s.maxChromaCosineDistance, 0.0);
+  ASSERT_FLOAT_EQ(s.maxChromaCosineDistance, s.meanChromaCosineDistance);
+  ASSERT_FLOAT_EQ(0.01, s.primarySeconds);
+}
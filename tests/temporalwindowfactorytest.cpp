@@ -24,14 +24,14 @@
 TEST (TemporalWindowFactoryTest, FrameSize) {
   KeyFinder::TemporalWindowFactory twf;
 
-  const std::vector<double>* tw1 = twf.getTemporalWindow(10);
+  std::shared_ptr<const std::vector<double> > tw1 = twf.getTemporalWindow(10);
   ASSERT_EQ(10, tw1->size());
 }
 
 TEST (TemporalWindowFactoryTest, Function) {
   KeyFinder::TemporalWindowFactory twf;
 
-  const std::vector<double>* tw1 = twf.getTemporalWindow(1000);
+  std::shared_ptr<const std::vector<double> > tw1 = twf.getTemporalWindow(1000);
 
   KeyFinder::WindowFunction win;
   for (unsigned int i = 0; i < 1000; i++) {
@@ -44,9 +44,9 @@ TEST (TemporalWindowFactoryTest, Function) {
 TEST (TemporalWindowFactoryTest, RepeatedWindowRequests) {
   KeyFinder::TemporalWindowFactory twf;
 
-  const std::vector<double>* tw1 = twf.getTemporalWindow(10);
-  const std::vector<double>* tw2 = twf.getTemporalWindow(10);
-  const std::vector<double>* tw3 = twf.getTemporalWindow(12);
+  std::shared_ptr<const std::vector<double> > tw1 = twf.getTemporalWindow(10);
+  std::shared_ptr<const std::vector<double> > tw2 = twf.getTemporalWindow(10);
+  std::shared_ptr<const std::vector<double> > tw3 = twf.getTemporalWindow(12);
 
   ASSERT_EQ(tw1, tw2);
   ASSERT_NE(tw2, tw3);
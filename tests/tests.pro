@@ -37,22 +37,35 @@ HEADERS += _testhelpers.h
 SOURCES += \
     main.cpp \
     _testhelpers.cpp \
+    analysisdiagnosticstest.cpp \
+    arrowexporttest.cpp \
     audiodatatest.cpp \
+    batchjournaltest.cpp \
     binodetest.cpp \
+    chromafingerprinttest.cpp \
     chromagramtest.cpp \
     chromatransformtest.cpp \
     chromatransformfactorytest.cpp \
     constantstest.cpp \
+    costestimatortest.cpp \
     downsamplershortcuttest.cpp \
+    executiondomaintest.cpp \
     fftadaptertest.cpp \
+    hopcachetest.cpp \
+    hopfeaturestest.cpp \
     keyclassifiertest.cpp \
     keyfindertest.cpp \
+    latencyhistogramtest.cpp \
     lowpassfiltertest.cpp \
     lowpassfilterfactorytest.cpp \
+    planregistrytest.cpp \
+    shadowevaluatortest.cpp \
     spectrumanalysertest.cpp \
     temporalwindowfactorytest.cpp \
+    tonalitygatetest.cpp \
     toneprofilestest.cpp \
     windowfunctiontest.cpp \
+    workloadrecordertest.cpp \
     workspacetest.cpp
 
 macx{
@@ -0,0 +1,225 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#include "_testhelpers.h"
+
+#include <random>
+
+static KeyFinder::AudioData white_noise(unsigned int sampleRate, double seconds, double amplitude) {
+  std::mt19937 generator(1);
+  std::normal_distribution<double> noise(0.0, amplitude);
+  KeyFinder::AudioData a;
+  a.setChannels(1);
+  a.setFrameRate(sampleRate);
+  a.addToFrameCount(sampleRate * seconds);
+  for (size_t i = 0; i < a.getFrameCount(); i++) {
+    a.setSampleByFrame(i, 0, noise(generator));
+  }
+  return a;
+}
+
+// white noise through the usual three-pole approximation of a 1/f slope
+static KeyFinder::AudioData pink_noise(unsigned int sampleRate, double seconds) {
+  std::mt19937 generator(2);
+  std::normal_distribution<double> noise(0.0, 0.2);
+  KeyFinder::AudioData a;
+  a.setChannels(1);
+  a.setFrameRate(sampleRate);
+  a.addToFrameCount(sampleRate * seconds);
+  double b0 = 0.0;
+  double b1 = 0.0;
+  double b2 = 0.0;
+  for (size_t i = 0; i < a.getFrameCount(); i++) {
+    double white = noise(generator);
+    b0 = 0.99765 * b0 + white * 0.0990460;
+    b1 = 0.96300 * b1 + white * 0.2965164;
+    b2 = 0.57000 * b2 + white * 1.0526913;
+    a.setSampleByFrame(i, 0, (b0 + b1 + b2 + white * 0.1848) * 0.3);
+  }
+  return a;
+}
+
+// white noise through a leaky integrator
+static KeyFinder::AudioData brown_noise(unsigned int sampleRate, double seconds) {
+  std::mt19937 generator(3);
+  std::normal_distribution<double> noise(0.0, 0.01);
+  KeyFinder::AudioData a;
+  a.setChannels(1);
+  a.setFrameRate(sampleRate);
+  a.addToFrameCount(sampleRate * seconds);
+  double level = 0.0;
+  for (size_t i = 0; i < a.getFrameCount(); i++) {
+    level = 0.995 * level + noise(generator);
+    a.setSampleByFrame(i, 0, level);
+  }
+  return a;
+}
+
+// syllables of a harmonic voice whose pitch wanders between about 80 and
+// 220Hz, shaped by three formants, with pauses and a faint noise floor
+static KeyFinder::AudioData speech_like(unsigned int sampleRate, double seconds) {
+  std::mt19937 generator(4);
+  std::normal_distribution<double> noise(0.0, 0.01);
+  KeyFinder::AudioData a;
+  a.setChannels(1);
+  a.setFrameRate(sampleRate);
+  a.addToFrameCount(sampleRate * seconds);
+  double phase = 0.0;
+  for (size_t i = 0; i < a.getFrameCount(); i++) {
+    double t = (double)i / sampleRate;
+    double f0 = 140.0 + 50.0 * sin(2 * PI * 0.7 * t) + 30.0 * sin(2 * PI * 3.1 * t);
+    phase += f0 / sampleRate;
+    double syllable = fmod(t, 0.25);
+    double envelope = syllable < 0.18 ? sin(PI * syllable / 0.18) : 0.0;
+    double voice = 0.0;
+    for (unsigned int h = 1; h <= 25; h++) {
+      double f = h * f0;
+      double formants = exp(-pow((f - 700.0) / 300.0, 2)) + 0.5 * exp(-pow((f - 1200.0) / 400.0, 2)) + 0.3 * exp(-pow((f - 2500.0) / 500.0, 2));
+      voice += formants * sin(2 * PI * h * phase);
+    }
+    a.setSampleByFrame(i, 0, 0.3 * envelope * voice + noise(generator));
+  }
+  return a;
+}
+
+TEST (TonalityGateTest, RejectsBadSettings) {
+  ASSERT_THROW(KeyFinder::TonalityGate(0.0), KeyFinder::Exception);
+  ASSERT_THROW(KeyFinder::TonalityGate(1.5), KeyFinder::Exception);
+  ASSERT_THROW(KeyFinder::TonalityGate(0.8, 0), KeyFinder::Exception);
+}
+
+TEST (TonalityGateTest, NoiseIsAtonal) {
+  KeyFinder::TonalityGate gate;
+  KeyFinder::TonalityVerdict v = gate.assess(white_noise(44100, 10.0, 0.2));
+  ASSERT_TRUE(v.atonal);
+  ASSERT_EQ(gate.getExcerpts(), v.excerpts);
+  ASSERT_GT(v.flatness, 0.4);
+  ASSERT_GT(v.chromaEntropy, 0.99);
+  ASSERT_GT(v.confidence, 0.9);
+}
+
+TEST (TonalityGateTest, ColouredNoiseIsAtonal) {
+  KeyFinder::TonalityGate gate;
+  KeyFinder::TonalityVerdict pink = gate.assess(pink_noise(44100, 20.0));
+  ASSERT_TRUE(pink.atonal);
+  ASSERT_EQ(gate.getExcerpts(), pink.excerpts);
+  KeyFinder::TonalityVerdict brown = gate.assess(brown_noise(44100, 20.0));
+  ASSERT_TRUE(brown.atonal);
+  ASSERT_GT(brown.excerpts, 0);
+}
+
+TEST (TonalityGateTest, SpeechIsAtonal) {
+  KeyFinder::TonalityGate gate;
+  KeyFinder::TonalityVerdict v = gate.assess(speech_like(44100, 20.0));
+  ASSERT_TRUE(v.atonal);
+  ASSERT_EQ(gate.getExcerpts(), v.excerpts);
+  ASSERT_GT(v.chromaEntropy, 0.96);
+}
+
+TEST (TonalityGateTest, TriadIsTonal) {
+  KeyFinder::TonalityGate gate;
+  KeyFinder::TonalityVerdict v = gate.assess(chord_audio(triad(440.0, true), 44100, 10.0));
+  ASSERT_FALSE(v.atonal);
+  ASSERT_LT(v.flatness, 0.05);
+  ASSERT_LT(v.chromaEntropy, 0.9);
+  ASSERT_NEAR(0.0, v.evidence, TINY);
+  ASSERT_NEAR(1.0, v.confidence, TINY);
+}
+
+TEST (TonalityGateTest, WorksAtHighFrameRates) {
+  KeyFinder::TonalityGate gate;
+  ASSERT_TRUE(gate.assess(white_noise(192000, 5.0, 0.2)).atonal);
+  ASSERT_FALSE(gate.assess(chord_audio(triad(440.0, true), 192000, 5.0)).atonal);
+}
+
+TEST (TonalityGateTest, InconclusiveOnQuietOrShortAudio) {
+  KeyFinder::TonalityGate gate;
+  KeyFinder::TonalityVerdict quiet = gate.assess(white_noise(44100, 10.0, 1e-6));
+  ASSERT_FALSE(quiet.atonal);
+  ASSERT_EQ(0, quiet.excerpts);
+  ASSERT_NEAR(0.0, quiet.confidence, TINY);
+
+  KeyFinder::TonalityVerdict tooShort = gate.assess(white_noise(44100, 0.05, 0.2));
+  ASSERT_FALSE(tooShort.atonal);
+  ASSERT_EQ(0, tooShort.excerpts);
+}
+
+TEST (TonalityGateTest, KeyOfAudioSkipsAtonalAudio) {
+  KeyFinder::KeyFinder k;
+  KeyFinder::TonalityGate gate;
+  KeyFinder::TonalityVerdict v;
+  ASSERT_EQ(KeyFinder::SILENCE, k.keyOfAudio(white_noise(44100, 10.0, 0.2), gate, v));
+  ASSERT_TRUE(v.atonal);
+
+  KeyFinder::AudioData music = chord_audio(triad(440.0, true), 44100, 10.0);
+  ASSERT_EQ(k.keyOfAudio(music), k.keyOfAudio(music, gate, v));
+  ASSERT_FALSE(v.atonal);
+}
+
+TEST (TonalityGateTest, LowRegisterTriadsAreTonal) {
+  KeyFinder::TonalityGate gate;
+  unsigned int sampleRates[] = { 44100, 48000 };
+  for (unsigned int r = 0; r < 2; r++) {
+    // ten seconds each of pure C3 and G3 major triads over a faint noise floor
+    KeyFinder::TonalityVerdict c = gate.assess(chord_audio(triad(130.8128, false), sampleRates[r], 10.0, 1.0 / 3, 0.001));
+    ASSERT_FALSE(c.atonal);
+    ASSERT_EQ(gate.getExcerpts(), c.excerpts);
+    ASSERT_LT(c.flatness, 0.05);
+    ASSERT_LT(c.chromaEntropy, 0.9);
+    KeyFinder::TonalityVerdict g = gate.assess(chord_audio(triad(195.9977, false), sampleRates[r], 10.0, 1.0 / 3, 0.001));
+    ASSERT_FALSE(g.atonal);
+    ASSERT_EQ(gate.getExcerpts(), g.excerpts);
+    ASSERT_LT(g.chromaEntropy, 0.9);
+  }
+}
+
+TEST (TonalityGateTest, ProgressionIsTonal) {
+  KeyFinder::TonalityGate gate;
+  // Am F C G E in the third octave, two seconds each
+  std::vector< std::vector<float> > chords;
+  chords.push_back(triad(220.0000, true));
+  chords.push_back(triad(174.6141, false));
+  chords.push_back(triad(130.8128, false));
+  chords.push_back(triad(195.9977, false));
+  chords.push_back(triad(164.8138, false));
+  KeyFinder::TonalityVerdict v = gate.assess(chord_audio(chords, 44100, 2.0, 1.0 / 3, 0.001));
+  ASSERT_FALSE(v.atonal);
+  ASSERT_EQ(gate.getExcerpts(), v.excerpts);
+  ASSERT_NEAR(0.0, v.evidence, TINY);
+}
+
+TEST (TonalityGateTest, InconclusiveWhenMostEnergyIsOutOfBand) {
+  // a 40Hz hum, with only a faint noise floor in the band the gate reads
+  std::mt19937 generator(1);
+  std::normal_distribution<double> noise(0.0, 0.001);
+  KeyFinder::AudioData a;
+  a.setChannels(1);
+  a.setFrameRate(44100);
+  a.addToFrameCount(44100 * 10);
+  for (size_t i = 0; i < a.getFrameCount(); i++) {
+    a.setSampleByFrame(i, 0, sine_wave(i, 40.0, 44100, 1) + noise(generator));
+  }
+  KeyFinder::TonalityGate gate;
+  KeyFinder::TonalityVerdict v = gate.assess(a);
+  ASSERT_FALSE(v.atonal);
+  ASSERT_EQ(0, v.excerpts);
+  ASSERT_NEAR(0.0, v.confidence, TINY);
+}
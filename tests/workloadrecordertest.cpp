@@ -0,0 +1,147 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#include "_testhelpers.h"
+
+TEST (WorkloadRecorderTest, RecordsStreamingCalls) {
+  KeyFinder::AudioData a;
+  a.setChannels(2);
+  a.setFrameRate(44100);
+  a.addToFrameCount(1024);
+
+  KeyFinder::KeyFinder k;
+  KeyFinder::Workspace w;
+  KeyFinder::WorkloadRecorder r;
+  w.recorder = &r;
+
+  for (unsigned int i = 0; i < 3; i++) {
+    k.progressiveChromagram(a, w);
+  }
+  k.keyOfChromagram(w);
+  k.finalChromagram(w);
+
+  std::vector<KeyFinder::WorkloadEvent> events = r.getEvents();
+  ASSERT_EQ(5, events.size());
+  ASSERT_EQ(KeyFinder::CALL_PROGRESSIVE_CHROMAGRAM, events[0].call);
+  ASSERT_EQ(1024, events[0].frames);
+  ASSERT_EQ(2, events[0].channels);
+  ASSERT_EQ(44100, events[0].frameRate);
+  ASSERT_FLOAT_EQ(0.0, events[0].startSeconds);
+  ASSERT_GE(events[1].startSeconds, events[0].startSeconds);
+  ASSERT_GE(events[2].durationSeconds, 0.0);
+  ASSERT_EQ(KeyFinder::CALL_KEY_OF_CHROMAGRAM, events[3].call);
+  ASSERT_EQ(KeyFinder::CALL_FINAL_CHROMAGRAM, events[4].call);
+
+  r.clear();
+  ASSERT_EQ(0, r.getEvents().size());
+}
+
+TEST (WorkloadRecorderTest, TraceRoundTrip) {
+  KeyFinder::WorkloadRecorder r;
+  std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+  r.record(KeyFinder::CALL_PROGRESSIVE_CHROMAGRAM, 512, 2, 44100, t, t + std::chrono::microseconds(30));
+  r.record(KeyFinder::CALL_PROGRESSIVE_CHROMAGRAM, 480, 2, 44100, t + std::chrono::microseconds(11610), t + std::chrono::microseconds(11650));
+  r.record(KeyFinder::CALL_KEY_OF_CHROMAGRAM, 0, 0, 0, t + std::chrono::microseconds(11700), t + std::chrono::microseconds(11720));
+  r.record(KeyFinder::CALL_PROGRESSIVE_CHROMAGRAM, 1000, 1, 48000, t + std::chrono::microseconds(20000), t + std::chrono::microseconds(20100));
+  r.record(KeyFinder::CALL_FINAL_CHROMAGRAM, 0, 0, 0, t + std::chrono::microseconds(30000), t + std::chrono::microseconds(35000));
+
+  std::stringstream trace;
+  r.write(trace);
+
+  KeyFinder::WorkloadRecorder replayed;
+  replayed.read(trace);
+
+  std::vector<KeyFinder::WorkloadEvent> before = r.getEvents();
+  std::vector<KeyFinder::WorkloadEvent> after = replayed.getEvents();
+  ASSERT_EQ(before.size(), after.size());
+  for (unsigned int i = 0; i < before.size(); i++) {
+    ASSERT_EQ(before[i].call, after[i].call);
+    ASSERT_EQ(before[i].frames, after[i].frames);
+    ASSERT_NEAR(before[i].startSeconds, after[i].startSeconds, 0.000001);
+    ASSERT_NEAR(before[i].durationSeconds, after[i].durationSeconds, 0.000001);
+  }
+  ASSERT_EQ(2, after[1].channels);
+  ASSERT_EQ(44100, after[1].frameRate);
+  ASSERT_EQ(1, after[3].channels);
+  ASSERT_EQ(48000, after[3].frameRate);
+}
+
+TEST (WorkloadRecorderTest, RecordsAnalysisRateAndSpectraCalls) {
+  KeyFinder::AudioData a;
+  a.setChannels(1);
+  a.setFrameRate(4410);
+  a.addToFrameCount(20000);
+  std::vector< std::vector<double> > spectra(3, std::vector<double>(8192 / 2 + 1, 1.0));
+
+  KeyFinder::KeyFinder k;
+  KeyFinder::Workspace w;
+  KeyFinder::WorkloadRecorder r;
+  KeyFinder::StreamingMetrics m;
+  KeyFinder::AnalysisDiagnostics d;
+  w.recorder = &r;
+  w.metrics = &m;
+  w.diagnostics = &d;
+  k.progressiveChromagramAtAnalysisRate(a, w);
+  KeyFinder::Workspace ws;
+  ws.recorder = &r;
+  ws.metrics = &m;
+  ws.diagnostics = &d;
+  k.progressiveChromagramOfSpectra(spectra, 8192, 8000, ws);
+
+  std::vector<KeyFinder::WorkloadEvent> events = r.getEvents();
+  ASSERT_EQ(2, events.size());
+  ASSERT_EQ(KeyFinder::CALL_ANALYSIS_RATE_CHROMAGRAM, events[0].call);
+  ASSERT_EQ(20000, events[0].frames);
+  ASSERT_EQ(1, events[0].channels);
+  ASSERT_EQ(4410, events[0].frameRate);
+  ASSERT_EQ(KeyFinder::CALL_SPECTRA_CHROMAGRAM, events[1].call);
+  ASSERT_EQ(3, events[1].frames);
+  ASSERT_EQ(8192, events[1].frameSize);
+  ASSERT_EQ(8000, events[1].frameRate);
+
+  ASSERT_EQ(2, m.progressiveChromagram.getCount());
+  ASSERT_EQ(2, d.calls);
+  ASSERT_EQ(20000, d.frames);
+  ASSERT_EQ(w.chromagram->getHops() + 3, d.hops);
+
+  std::stringstream trace;
+  r.write(trace);
+  KeyFinder::WorkloadRecorder replayed;
+  replayed.read(trace);
+  std::vector<KeyFinder::WorkloadEvent> after = replayed.getEvents();
+  ASSERT_EQ(2, after.size());
+  ASSERT_EQ(KeyFinder::CALL_ANALYSIS_RATE_CHROMAGRAM, after[0].call);
+  ASSERT_EQ(4410, after[0].frameRate);
+  ASSERT_EQ(KeyFinder::CALL_SPECTRA_CHROMAGRAM, after[1].call);
+  ASSERT_EQ(3, after[1].frames);
+  ASSERT_EQ(8192, after[1].frameSize);
+  ASSERT_EQ(8000, after[1].frameRate);
+}
+
+TEST (WorkloadRecorderTest, RejectsMalformedTraces) {
+  KeyFinder::WorkloadRecorder r;
+  std::stringstream notATrace("hello\n");
+  ASSERT_THROW(r.read(notATrace), KeyFinder::Exception);
+  std::stringstream noFormat("keyfinder-workload 1\np 0 10 512\n");
+  ASSERT_THROW(r.read(noFormat), KeyFinder::Exception);
+  std::stringstream unknownCall("keyfinder-workload 1\nx 0 10\n");
+  ASSERT_THROW(r.read(unknownCall), KeyFinder::Exception);
+}
@@ -35,4 +35,10 @@ TEST (WorkspaceTest, ConstructorDefaultsWork) {
   ASSERT_EQ(NULL, w.chromagram);
   ASSERT_EQ(NULL, w.fftAdapter);
   ASSERT_EQ(NULL, w.lpfBuffer);
+  ASSERT_EQ(NULL, w.recorder);
+  ASSERT_EQ(NULL, w.metrics);
+  ASSERT_EQ(NULL, w.hopCache);
+  ASSERT_EQ(NULL, w.diagnostics);
+  ASSERT_EQ(NULL, w.features);
+  ASSERT_EQ(NULL, w.fingerprint);
 }
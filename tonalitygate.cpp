@@ -0,0 +1,212 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#include "tonalitygate.h"
+#include "hopfeatures.h"
+#include "temporalwindowfactory.h"
+
+namespace KeyFinder {
+
+  // excerpts quieter than about -80dBFS say nothing either way
+  static const double QUIET_RMS = 1e-4;
+
+  // the band folded into pitch classes: whole octaves from where bins are at
+  // most half a semitone wide, up to where most pitched energy has died away.
+  // Excerpts are decimated to about 11kHz so that a 4096-point FFT resolves
+  // semitones down into the bass: about 90Hz to 2.9kHz from 44.1kHz audio,
+  // and 98Hz to 3.2kHz from 48kHz.
+  static const double LOWEST_GATE_FREQUENCY = 80.0;
+  static const double HIGHEST_GATE_FREQUENCY = 5000.0;
+  static const double BINS_PER_SEMITONE = 2.0;
+  static const unsigned int GATE_FRAME_RATE = 11025;
+
+  // excerpts with less of their energy in the band than this say nothing
+  // either way, rather than leaving whatever noise is in the band to decide
+  static const double MIN_BAND_SHARE = 0.1;
+
+  // each feature's evidence ramps from 0 to 1 between these
+  static const double TONAL_FLATNESS = 0.02;
+  static const double ATONAL_FLATNESS = 0.10;
+  static const double TONAL_ENTROPY = 0.90;
+  static const double ATONAL_ENTROPY = 0.96;
+
+  TonalityVerdict::TonalityVerdict() :
+    atonal(false), confidence(0.0), evidence(0.0), flatness(0.0), chromaEntropy(0.0), rms(0.0), excerpts(0) { }
+
+  TonalityGate::TonalityGate(double inThreshold, unsigned int inExcerpts) :
+    threshold(inThreshold), excerpts(inExcerpts), fft(FRAME_SIZE), mappedFrameRate(0), firstBin(0) {
+    if (threshold <= 0.0 || threshold > 1.0) {
+      throw Exception("Tonality gate threshold must be in (0, 1]");
+    }
+    if (excerpts == 0) {
+      throw Exception("Tonality gate needs at least one excerpt");
+    }
+    TemporalWindowFactory twFactory;
+    window = twFactory.getTemporalWindow(FRAME_SIZE);
+  }
+
+  double TonalityGate::getThreshold() const {
+    return threshold;
+  }
+
+  unsigned int TonalityGate::getExcerpts() const {
+    return excerpts;
+  }
+
+  void TonalityGate::mapBins(unsigned int frameRate) {
+    if (frameRate == mappedFrameRate) {
+      return;
+    }
+    double binWidth = frameRate / (double)FRAME_SIZE;
+    double semitoneRatio = pow(2.0, 1.0 / SEMITONES);
+    double lowest = std::max(LOWEST_GATE_FREQUENCY, BINS_PER_SEMITONE * binWidth / (semitoneRatio - 1.0));
+    double highest = std::min(HIGHEST_GATE_FREQUENCY, frameRate * 0.45);
+    pitchClassOfBin.clear();
+    firstBin = (unsigned int)ceil(lowest / binWidth);
+    if (highest > lowest) {
+      // whole octaves, so that each pitch class covers the same span
+      double octaves = floor(log2(highest / lowest));
+      unsigned int lastBin = (unsigned int)floor(lowest * pow(2.0, octaves) / binWidth);
+      for (unsigned int bin = firstBin; bin < lastBin; bin++) {
+        double semitonesFromA = SEMITONES * log2(bin * binWidth / 440.0);
+        int pitchClass = (int)floor(semitonesFromA + 0.5) % (int)SEMITONES;
+        pitchClassOfBin.push_back((pitchClass + SEMITONES) % SEMITONES);
+      }
+    }
+    mappedFrameRate = frameRate;
+  }
+
+  static double evidenceBetween(double value, double tonal, double atonal) {
+    return std::max(0.0, std::min(1.0, (value - tonal) / (atonal - tonal)));
+  }
+
+  TonalityVerdict TonalityGate::assess(const AudioData& audio) {
+
+    TonalityVerdict verdict;
+    size_t frames = audio.getFrameCount();
+    unsigned int channels = audio.getChannels();
+    // averaged down to roughly 11 or 12kHz, so that the bins are narrow
+    // enough to resolve semitones in the lower octaves
+    unsigned int decimation = std::max(1u, audio.getFrameRate() / GATE_FRAME_RATE);
+    unsigned int frameRate = audio.getFrameRate() / decimation;
+    size_t excerptFrames = (size_t)FRAME_SIZE * decimation;
+    if (frames < excerptFrames || channels == 0) {
+      return verdict;
+    }
+    mapBins(frameRate);
+    if (pitchClassOfBin.size() < SEMITONES) {
+      return verdict;
+    }
+
+    std::vector<double> chroma(SEMITONES, 0.0);
+    std::vector<double> binsPerClass(SEMITONES, 0.0);
+    for (unsigned int i = 0; i < pitchClassOfBin.size(); i++) {
+      binsPerClass[pitchClassOfBin[i]] += 1.0;
+    }
+    std::vector<double> flatnesses;
+    std::vector<double> band(pitchClassOfBin.size());
+    std::vector<double> excerptChroma(SEMITONES);
+    HopFeatures features(1);
+
+    for (unsigned int e = 0; e < excerpts; e++) {
+      // spread evenly, each centred in its share of the audio
+      size_t start = (size_t)((frames - excerptFrames) * ((e + 0.5) / excerpts));
+      double sumOfSquares = 0.0;
+      for (unsigned int i = 0; i < FRAME_SIZE; i++) {
+        double sample = 0.0;
+        for (unsigned int d = 0; d < decimation; d++) {
+          for (unsigned int c = 0; c < channels; c++) {
+            sample += audio.getSampleByFrame(start + (size_t)i * decimation + d, c);
+          }
+        }
+        sample /= channels * decimation;
+        sumOfSquares += sample * sample;
+        fft.setInput(i, sample * (*window)[i]);
+      }
+      double rms = sqrt(sumOfSquares / FRAME_SIZE);
+      verdict.rms = std::max(verdict.rms, rms);
+      if (rms < QUIET_RMS) {
+        continue;
+      }
+      fft.execute();
+
+      // mean power per bin of each class, so that the wider classes at the
+      // top of each octave don't win on bin count alone
+      std::fill(excerptChroma.begin(), excerptChroma.end(), 0.0);
+      double total = 0.0;
+      double bandPower = 0.0;
+      for (unsigned int i = 0; i < band.size(); i++) {
+        band[i] = fft.getOutputMagnitude(firstBin + i);
+        bandPower += band[i] * band[i];
+        double power = band[i] * band[i] / binsPerClass[pitchClassOfBin[i]];
+        excerptChroma[pitchClassOfBin[i]] += power;
+        total += power;
+      }
+      double excerptPower = 0.0;
+      for (unsigned int bin = 1; bin <= FRAME_SIZE / 2; bin++) {
+        double magnitude = fft.getOutputMagnitude(bin);
+        excerptPower += magnitude * magnitude;
+      }
+      if (total <= 0.0 || bandPower < MIN_BAND_SHARE * excerptPower) {
+        continue;
+      }
+      for (unsigned int p = 0; p < SEMITONES; p++) {
+        chroma[p] += excerptChroma[p] / total;
+      }
+      features.setSpectralFeatures(0, band, frameRate, FRAME_SIZE);
+      flatnesses.push_back(features.getFeature(0, FEATURE_FLATNESS));
+    }
+
+    verdict.excerpts = flatnesses.size();
+    if (verdict.excerpts == 0) {
+      return verdict;
+    }
+
+    std::nth_element(flatnesses.begin(), flatnesses.begin() + flatnesses.size() / 2, flatnesses.end());
+    verdict.flatness = flatnesses[flatnesses.size() / 2];
+
+    double entropy = 0.0;
+    for (unsigned int p = 0; p < SEMITONES; p++) {
+      double share = chroma[p] / verdict.excerpts;
+      if (share > 0.0) {
+        entropy -= share * log(share);
+      }
+    }
+    verdict.chromaEntropy = entropy / log((double)SEMITONES);
+
+    // both features have to lean atonal. Noise and speech, whose partials
+    // glide and stop within an excerpt, are somewhat flat and spread over
+    // every pitch class; music can be either, through drums or through
+    // chords that cover all twelve classes, but rarely both at once
+    verdict.evidence = sqrt(
+      evidenceBetween(verdict.flatness, TONAL_FLATNESS, ATONAL_FLATNESS) *
+      evidenceBetween(verdict.chromaEntropy, TONAL_ENTROPY, ATONAL_ENTROPY)
+    );
+    verdict.atonal = verdict.evidence >= threshold;
+    if (verdict.atonal) {
+      verdict.confidence = (threshold < 1.0) ? (verdict.evidence - threshold) / (1.0 - threshold) : 1.0;
+    } else {
+      verdict.confidence = (threshold - verdict.evidence) / threshold;
+    }
+    return verdict;
+  }
+
+}
@@ -0,0 +1,79 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#ifndef TONALITYGATE_H
+#define TONALITYGATE_H
+
+#include "constants.h"
+#include "audiodata.h"
+#include "fftadapter.h"
+#include <memory>
+
+namespace KeyFinder {
+
+  // What the gate measured. Evidence runs from 0 for clearly tonal to 1 for
+  // clearly atonal, and confidence is how far it sits from the threshold on
+  // the side of the verdict; it is 0 when no excerpt was loud enough to judge,
+  // or none had enough of its energy in the band the gate folds into chroma.
+  class TonalityVerdict {
+  public:
+    TonalityVerdict();
+    bool atonal;
+    double confidence;
+    double evidence;
+    double flatness;       // median spectral flatness of the excerpts
+    double chromaEntropy;  // of their pooled chroma; 1 for an even spread
+    double rms;            // of the loudest excerpt
+    unsigned int excerpts; // loud enough, and with enough energy in band, to count
+  };
+
+  // A cheap check for speech, effects and noise before the full pipeline.
+  // It reads a few short excerpts spread across the audio, averaged down to
+  // about 11kHz rather than put through the low-pass filter, with a
+  // 4096-point FFT rather than the analyser's 16384, and judges them on
+  // spectral flatness and how evenly their energy spreads over the twelve
+  // pitch classes between about 90Hz and 3kHz; audio is only rejected when
+  // both lean atonal. It errs towards passing audio on, so quiet or very
+  // short audio, and excerpts with less than a tenth of their energy in that
+  // band, are never rejected. Not thread-safe; use one per thread.
+  class TonalityGate {
+  public:
+    TonalityGate(double threshold = 0.8, unsigned int excerpts = 8);
+    TonalityVerdict assess(const AudioData& audio);
+    double getThreshold() const;
+    unsigned int getExcerpts() const;
+    static const unsigned int FRAME_SIZE = 4096;
+  private:
+    TonalityGate(const TonalityGate&);
+    TonalityGate& operator=(const TonalityGate&);
+    void mapBins(unsigned int frameRate);
+    double threshold;
+    unsigned int excerpts;
+    FftAdapter fft;
+    std::shared_ptr<const std::vector<double> > window;
+    unsigned int mappedFrameRate;
+    unsigned int firstBin;
+    std::vector<unsigned int> pitchClassOfBin; // from firstBin
+  };
+
+}
+
+#endif
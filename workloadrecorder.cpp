@@ -0,0 +1,153 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#include "workloadrecorder.h"
+
+namespace KeyFinder {
+
+  static const char* TRACE_HEADER = "keyfinder-workload 1";
+  static const char CALL_CODES[] = { 'p', 'f', 'k', 'a', 's' };
+
+  WorkloadRecorder::WorkloadRecorder() : events(0), started(false) { }
+
+  void WorkloadRecorder::record(workload_call_t call, size_t frames, unsigned int channels, unsigned int frameRate, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end, unsigned int frameSize) {
+    std::lock_guard<std::mutex> lock(workloadRecorderMutex);
+    if (!started) {
+      origin = start;
+      started = true;
+    }
+    WorkloadEvent e;
+    e.call = call;
+    e.frames = frames;
+    e.channels = channels;
+    e.frameRate = frameRate;
+    e.frameSize = frameSize;
+    e.startSeconds = std::chrono::duration<double>(start - origin).count();
+    e.durationSeconds = std::chrono::duration<double>(end - start).count();
+    events.push_back(e);
+  }
+
+  std::vector<WorkloadEvent> WorkloadRecorder::getEvents() const {
+    std::lock_guard<std::mutex> lock(workloadRecorderMutex);
+    return events;
+  }
+
+  void WorkloadRecorder::clear() {
+    std::lock_guard<std::mutex> lock(workloadRecorderMutex);
+    events.clear();
+    started = false;
+  }
+
+  // One line per call; start times are delta-encoded in microseconds, and the
+  // format of a progressive call is only repeated when it changes. Spectra
+  // calls always carry their frame size and rate.
+  void WorkloadRecorder::write(std::ostream& trace) const {
+    std::lock_guard<std::mutex> lock(workloadRecorderMutex);
+    trace << TRACE_HEADER << "\n";
+    long long previousStart = 0;
+    unsigned int channels = 0;
+    unsigned int frameRate = 0;
+    for (unsigned int i = 0; i < events.size(); i++) {
+      const WorkloadEvent& e = events[i];
+      long long start = llround(e.startSeconds * 1.0e6);
+      trace << CALL_CODES[e.call] << " " << (start - previousStart) << " " << llround(e.durationSeconds * 1.0e6);
+      if (e.call == CALL_PROGRESSIVE_CHROMAGRAM || e.call == CALL_ANALYSIS_RATE_CHROMAGRAM) {
+        trace << " " << e.frames;
+        if (e.channels != channels || e.frameRate != frameRate) {
+          trace << " " << e.channels << " " << e.frameRate;
+          channels = e.channels;
+          frameRate = e.frameRate;
+        }
+      } else if (e.call == CALL_SPECTRA_CHROMAGRAM) {
+        trace << " " << e.frames << " " << e.frameSize << " " << e.frameRate;
+      }
+      trace << "\n";
+      previousStart = start;
+    }
+  }
+
+  void WorkloadRecorder::read(std::istream& trace) {
+    std::string header;
+    std::getline(trace, header);
+    if (header != TRACE_HEADER) {
+      throw Exception("Not a workload trace");
+    }
+    std::vector<WorkloadEvent> readEvents;
+    long long start = 0;
+    unsigned int channels = 0;
+    unsigned int frameRate = 0;
+    std::string line;
+    while (std::getline(trace, line)) {
+      if (line.empty()) {
+        continue;
+      }
+      std::istringstream fields(line);
+      char code;
+      long long startDelta;
+      long long duration;
+      if (!(fields >> code >> startDelta >> duration)) {
+        throw Exception("Malformed workload trace");
+      }
+      WorkloadEvent e;
+      e.frames = 0;
+      e.frameSize = 0;
+      e.channels = channels;
+      e.frameRate = frameRate;
+      if (code == CALL_CODES[CALL_PROGRESSIVE_CHROMAGRAM] || code == CALL_CODES[CALL_ANALYSIS_RATE_CHROMAGRAM]) {
+        e.call = (code == CALL_CODES[CALL_PROGRESSIVE_CHROMAGRAM]) ? CALL_PROGRESSIVE_CHROMAGRAM : CALL_ANALYSIS_RATE_CHROMAGRAM;
+        if (!(fields >> e.frames)) {
+          throw Exception("Malformed workload trace");
+        }
+        unsigned int newChannels;
+        unsigned int newFrameRate;
+        if (fields >> newChannels >> newFrameRate) {
+          channels = newChannels;
+          frameRate = newFrameRate;
+        }
+        if (channels == 0 || frameRate == 0) {
+          throw Exception("Workload trace has no audio format");
+        }
+        e.channels = channels;
+        e.frameRate = frameRate;
+      } else if (code == CALL_CODES[CALL_SPECTRA_CHROMAGRAM]) {
+        e.call = CALL_SPECTRA_CHROMAGRAM;
+        e.channels = 0;
+        if (!(fields >> e.frames >> e.frameSize >> e.frameRate)) {
+          throw Exception("Malformed workload trace");
+        }
+      } else if (code == CALL_CODES[CALL_FINAL_CHROMAGRAM]) {
+        e.call = CALL_FINAL_CHROMAGRAM;
+      } else if (code == CALL_CODES[CALL_KEY_OF_CHROMAGRAM]) {
+        e.call = CALL_KEY_OF_CHROMAGRAM;
+      } else {
+        throw Exception("Unknown call in workload trace");
+      }
+      start += startDelta;
+      e.startSeconds = start / 1.0e6;
+      e.durationSeconds = duration / 1.0e6;
+      readEvents.push_back(e);
+    }
+    std::lock_guard<std::mutex> lock(workloadRecorderMutex);
+    events = readEvents;
+    started = false;
+  }
+
+}
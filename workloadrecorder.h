@@ -0,0 +1,70 @@
+/*************************************************************************
+
+  Copyright 2011-2015 Ibrahim Sha'ath
+
+  This file is part of LibKeyFinder.
+
+  LibKeyFinder is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  LibKeyFinder is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with LibKeyFinder.  If not, see <http://www.gnu.org/licenses/>.
+
+*************************************************************************/
+
+#ifndef WORKLOADRECORDER_H
+#define WORKLOADRECORDER_H
+
+#include "constants.h"
+#include <chrono>
+#include <istream>
+#include <ostream>
+
+namespace KeyFinder {
+
+  enum workload_call_t {
+    CALL_PROGRESSIVE_CHROMAGRAM,
+    CALL_FINAL_CHROMAGRAM,
+    CALL_KEY_OF_CHROMAGRAM,
+    CALL_ANALYSIS_RATE_CHROMAGRAM, // progressiveChromagramAtAnalysisRate
+    CALL_SPECTRA_CHROMAGRAM        // progressiveChromagramOfSpectra; frames counts spectra
+  };
+
+  class WorkloadEvent {
+  public:
+    workload_call_t call;
+    size_t frames;
+    unsigned int channels;
+    unsigned int frameRate;
+    unsigned int frameSize; // of spectra calls only
+    double startSeconds; // since the first recorded call
+    double durationSeconds;
+  };
+
+  // Records the shape of a streaming workload (calls, packet sizes, rates and
+  // timings, but no audio content) so that it can be replayed by benchmarks.
+  class WorkloadRecorder {
+  public:
+    WorkloadRecorder();
+    void record(workload_call_t call, size_t frames, unsigned int channels, unsigned int frameRate, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end, unsigned int frameSize = 0);
+    std::vector<WorkloadEvent> getEvents() const;
+    void clear();
+    void write(std::ostream& trace) const;
+    void read(std::istream& trace);
+  private:
+    std::vector<WorkloadEvent> events;
+    bool started;
+    std::chrono::steady_clock::time_point origin;
+    mutable std::mutex workloadRecorderMutex;
+  };
+
+}
+
+#endif
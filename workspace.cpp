@@ -23,7 +23,7 @@
 
 namespace KeyFinder {
 
-  Workspace::Workspace() : remainderBuffer(), preprocessedBuffer(), chromagram(NULL), fftAdapter(NULL), lpfBuffer(NULL) { }
+  Workspace::Workspace() : remainderBuffer(), preprocessedBuffer(), chromagram(NULL), fftAdapter(NULL), lpfBuffer(NULL), lowPassFilter(), chromaTransform(), temporalWindow(), recorder(NULL), metrics(NULL), hopCache(NULL), diagnostics(NULL), features(NULL), fingerprint(NULL) { }
 
   Workspace::~Workspace() {
     if (fftAdapter != NULL)
@@ -22,13 +22,23 @@
 #ifndef WORKSPACE_H
 #define WORKSPACE_H
 
+#include "analysisdiagnostics.h"
 #include "audiodata.h"
 #include "binode.h"
+#include "chromafingerprint.h"
 #include "chromagram.h"
+#include "chromatransform.h"
 #include "fftadapter.h"
+#include "hopcache.h"
+#include "hopfeatures.h"
+#include "latencyhistogram.h"
+#include "workloadrecorder.h"
+#include <memory>
 
 namespace KeyFinder {
 
+  class LowPassFilter;
+
   class Workspace {
   public:
     Workspace();
@@ -38,6 +48,16 @@ namespace KeyFinder {
     Chromagram* chromagram;
     FftAdapter* fftAdapter;
     std::vector<double>* lpfBuffer;
+    // plans from the PlanRegistry, held while the stream lasts
+    std::shared_ptr<const LowPassFilter> lowPassFilter;
+    std::shared_ptr<const ChromaTransform> chromaTransform;
+    std::shared_ptr<const std::vector<double> > temporalWindow;
+    WorkloadRecorder* recorder; // optional, not owned
+    StreamingMetrics* metrics;  // optional, not owned
+    HopCache* hopCache;         // optional, not owned
+    AnalysisDiagnostics* diagnostics; // optional, not owned
+    HopFeatures* features;      // optional, not owned
+    ChromaFingerprint* fingerprint; // optional, not owned
   };
 
 }